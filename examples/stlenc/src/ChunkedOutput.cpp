@@ -0,0 +1,160 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ChunkedOutput.h"
+
+#include <algorithm>
+
+
+namespace stlenc {
+
+ChunkedOutput::ChunkedOutput(prt::SimpleOutputCallbacks* soh, uint64_t handle, std::unique_ptr<Compressor> compressor,
+                             size_t writerBuffers, size_t chunkSize)
+		: mCallbacks(soh), mHandle(handle), mChunkSize(chunkSize), mCompressor(std::move(compressor)) {
+	mBuffer.reserve(chunkSize);
+	if (writerBuffers > 0) {
+		mPool.resize(writerBuffers);
+		for (std::vector<uint8_t>& b: mPool)
+			b.reserve(chunkSize);
+		mWriter = std::thread(&ChunkedOutput::runWriter, this);
+	}
+}
+
+
+ChunkedOutput::~ChunkedOutput() {
+	stopWriter(); // only if finish() was not reached, e.g. because of an exception
+}
+
+
+void ChunkedOutput::append(const uint8_t* data, size_t size) {
+	while (size > 0) {
+		const size_t n = std::min(size, mChunkSize - std::min(mBuffer.size(), mChunkSize));
+		mBuffer.insert(mBuffer.end(), data, data + n);
+		data += n;
+		size -= n;
+		commit();
+	}
+}
+
+
+void ChunkedOutput::flush() {
+	if (!mBuffer.empty())
+		write(false);
+}
+
+
+void ChunkedOutput::finish() {
+	if (mWriter.joinable()) {
+		write(true);
+		mWriter.join();
+		if (mWriterError)
+			std::rethrow_exception(mWriterError);
+	}
+	else if (!mBuffer.empty() || mCompressor)
+		write(true);
+}
+
+
+void ChunkedOutput::write(bool finish) {
+	const auto t0 = std::chrono::steady_clock::now();
+	mBytesFlushed += mBuffer.size();
+	if (mWriter.joinable()) {
+		// hand the chunk over to the writer thread and continue with a free buffer
+		std::unique_lock<std::mutex> lock(mMutex);
+		mChanged.wait(lock, [this] { return !mPool.empty() || mWriterError; });
+		if (mWriterError)
+			std::rethrow_exception(mWriterError);
+		mQueue.push_back({ std::move(mBuffer), finish });
+		mBuffer = std::move(mPool.back());
+		mPool.pop_back();
+		lock.unlock();
+		mChanged.notify_all();
+	}
+	else
+		writeChunk(mBuffer, finish);
+	mBuffer.clear();
+	mBlockingTime += std::chrono::steady_clock::now() - t0;
+}
+
+
+void ChunkedOutput::writeChunk(const std::vector<uint8_t>& chunk, bool finish) {
+	const std::vector<uint8_t>* data = &chunk;
+	if (mCompressor) {
+		const auto t0 = std::chrono::steady_clock::now();
+		mCompressed.clear();
+		mCompressor->compress(chunk.data(), chunk.size(), finish, mCompressed);
+		mCompressionTime += std::chrono::steady_clock::now() - t0;
+		data = &mCompressed;
+	}
+
+	if (!data->empty()) {
+		const auto t0 = std::chrono::steady_clock::now();
+		mCallbacks->write(mHandle, data->data(), data->size());
+		mWriteTime += std::chrono::steady_clock::now() - t0;
+		mBytesWritten += data->size();
+	}
+}
+
+
+void ChunkedOutput::runWriter() {
+	try {
+		for (;;) {
+			std::unique_lock<std::mutex> lock(mMutex);
+			mChanged.wait(lock, [this] { return !mQueue.empty() || mStopWriter; });
+			if (mQueue.empty())
+				return; // stopped
+			Chunk chunk = std::move(mQueue.front());
+			mQueue.pop_front();
+			lock.unlock();
+
+			writeChunk(chunk.data, chunk.finish);
+
+			chunk.data.clear();
+			lock.lock();
+			mPool.push_back(std::move(chunk.data));
+			lock.unlock();
+			mChanged.notify_all();
+			if (chunk.finish)
+				return;
+		}
+	}
+	catch (...) {
+		std::lock_guard<std::mutex> lock(mMutex);
+		mWriterError = std::current_exception();
+		mChanged.notify_all();
+	}
+}
+
+
+void ChunkedOutput::stopWriter() {
+	if (!mWriter.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopWriter = true;
+		mQueue.clear();
+	}
+	mChanged.notify_all();
+	mWriter.join();
+}
+
+} // namespace stlenc
@@ -0,0 +1,130 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Compression.h"
+
+#include "prt/Callbacks.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+namespace stlenc {
+
+constexpr size_t DEFAULT_CHUNK_SIZE = size_t(2) << 20; // 2 MB
+
+/**
+ * Collects encoder output in a fixed-size buffer and passes it on to the output callbacks whenever it is full.
+ * The memory needed for writing thus does not depend on the size of the written file.
+ * Text (ASCII STL) is kept as UTF-8 and written through the byte API as well, without a wide intermediate.
+ * If a compressor is given, each chunk is compressed before it is passed on.
+ *
+ * With writerBuffers > 0, full chunks are compressed and written in order by a dedicated writer thread, and the
+ * caller continues with a free buffer from a pool of that size. If all buffers are queued for writing, the caller
+ * waits until the writer returns one (backpressure), so the memory stays bounded by (writerBuffers + 1) chunks.
+ */
+class ChunkedOutput {
+public:
+	ChunkedOutput(prt::SimpleOutputCallbacks* soh, uint64_t handle, std::unique_ptr<Compressor> compressor = {},
+	              size_t writerBuffers = 0, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+	ChunkedOutput(const ChunkedOutput&) = delete;
+	ChunkedOutput(ChunkedOutput&&) = delete;
+	ChunkedOutput& operator=(ChunkedOutput&) = delete;
+	~ChunkedOutput();
+
+	/// the current chunk, data appended to it is written by the next commit() or flush()
+	std::vector<uint8_t>& getBuffer() { return mBuffer; }
+
+	/// writes the current chunk if it reached the chunk size
+	void commit() {
+		if (mBuffer.size() >= mChunkSize)
+			flush();
+	}
+
+	void append(const uint8_t* data, size_t size);
+	void append(std::string_view text) { append(reinterpret_cast<const uint8_t*>(text.data()), text.size()); }
+	void flush();
+
+	/**
+	 * Flushes the remaining data, terminates the compressed stream and waits until the writer thread is done.
+	 * Nothing may be appended afterwards. Rethrows errors of the writer thread.
+	 */
+	void finish();
+
+	bool isCompressed() const { return mCompressor != nullptr; }
+
+	/// number of (uncompressed) bytes appended so far, i.e. the offset of the next appended byte in the file
+	uint64_t getPosition() const { return mBytesFlushed + mBuffer.size(); }
+
+	/// written bytes and time spent in the output callbacks and in compression (in milliseconds), final after finish()
+	uint64_t getBytesWritten() const { return mBytesWritten; }
+	double getWriteTime() const { return mWriteTime.count(); }
+	double getCompressionTime() const { return mCompressionTime.count(); }
+
+	/// time the caller was blocked by writing, or by waiting for a free buffer with a writer thread
+	double getBlockingTime() const { return mBlockingTime.count(); }
+
+private:
+	using Duration = std::chrono::duration<double, std::milli>;
+
+	struct Chunk {
+		std::vector<uint8_t> data;
+		bool                 finish;
+	};
+
+	prt::SimpleOutputCallbacks* mCallbacks;
+	const uint64_t              mHandle;
+	const size_t                mChunkSize;
+	std::unique_ptr<Compressor> mCompressor;
+	std::vector<uint8_t>        mBuffer;
+	std::vector<uint8_t>        mCompressed;
+	uint64_t                    mBytesFlushed = 0;
+	uint64_t                    mBytesWritten = 0;
+	Duration                    mWriteTime{};
+	Duration                    mCompressionTime{};
+	Duration                    mBlockingTime{};
+
+	// writer thread, the queue and the pool are guarded by mMutex
+	std::thread                       mWriter;
+	std::mutex                        mMutex;
+	std::condition_variable           mChanged;
+	std::deque<Chunk>                 mQueue;
+	std::vector<std::vector<uint8_t>> mPool;
+	std::exception_ptr                mWriterError;
+	bool                              mStopWriter = false;
+
+	void write(bool finish);
+	void writeChunk(const std::vector<uint8_t>& chunk, bool finish);
+	void runWriter();
+	void stopWriter();
+};
+
+} // namespace stlenc
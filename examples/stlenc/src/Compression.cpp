@@ -0,0 +1,217 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Compression.h"
+
+#include <algorithm>
+#include <cwchar>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#ifdef STLENC_WITH_ZLIB
+#	include <zlib.h>
+#endif
+
+#ifdef STLENC_WITH_ZSTD
+#	include <zstd.h>
+#endif
+
+
+namespace {
+
+constexpr size_t OUTPUT_STEP = size_t(64) << 10;
+
+const std::pair<const wchar_t*, stlenc::Compression> COMPRESSIONS[] = {
+	{ L"none", stlenc::Compression::NONE },
+	{ L"gzip", stlenc::Compression::GZIP },
+	{ L"zstd", stlenc::Compression::ZSTD }
+};
+
+#ifdef STLENC_WITH_ZLIB
+class GzipCompressor : public stlenc::Compressor {
+public:
+	explicit GzipCompressor(int level) {
+		// windowBits 15 + 16 selects the gzip container instead of raw zlib
+		if (deflateInit2(&mStream, (level == 0) ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED, 15 + 16, 8,
+		                 Z_DEFAULT_STRATEGY) != Z_OK)
+			throw std::runtime_error("failed to initialize gzip compression");
+	}
+
+	~GzipCompressor() override {
+		deflateEnd(&mStream);
+	}
+
+	void compress(const uint8_t* data, size_t size, bool finish, std::vector<uint8_t>& out) override {
+		mStream.next_in = const_cast<Bytef*>(data);
+		mStream.avail_in = static_cast<uInt>(size);
+		const int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+		int ret = Z_OK;
+		do {
+			const size_t offset = out.size();
+			out.resize(offset + OUTPUT_STEP);
+			mStream.next_out = out.data() + offset;
+			mStream.avail_out = static_cast<uInt>(OUTPUT_STEP);
+			ret = deflate(&mStream, flush);
+			if (ret == Z_STREAM_ERROR)
+				throw std::runtime_error("gzip compression failed");
+			out.resize(offset + OUTPUT_STEP - mStream.avail_out);
+		} while (mStream.avail_out == 0 || (finish && ret != Z_STREAM_END));
+	}
+
+private:
+	z_stream mStream = {};
+};
+#endif
+
+#ifdef STLENC_WITH_ZSTD
+class ZstdCompressor : public stlenc::Compressor {
+public:
+	explicit ZstdCompressor(int level) : mContext(ZSTD_createCCtx()) {
+		if (mContext == nullptr || ZSTD_isError(ZSTD_CCtx_setParameter(mContext, ZSTD_c_compressionLevel, level)))
+			throw std::runtime_error("failed to initialize zstd compression");
+	}
+
+	~ZstdCompressor() override {
+		ZSTD_freeCCtx(mContext);
+	}
+
+	void compress(const uint8_t* data, size_t size, bool finish, std::vector<uint8_t>& out) override {
+		ZSTD_inBuffer input = { data, size, 0 };
+		const ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+		size_t remaining = 0;
+		do {
+			const size_t offset = out.size();
+			out.resize(offset + OUTPUT_STEP);
+			ZSTD_outBuffer output = { out.data() + offset, OUTPUT_STEP, 0 };
+			remaining = ZSTD_compressStream2(mContext, &output, &input, mode);
+			if (ZSTD_isError(remaining))
+				throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(remaining));
+			out.resize(offset + output.pos);
+		} while (finish ? (remaining != 0) : (input.pos < input.size));
+	}
+
+private:
+	ZSTD_CCtx* mContext;
+};
+#endif
+
+} // namespace
+
+
+namespace stlenc {
+
+std::unique_ptr<Compressor> Compressor::create(Compression compression, int level) {
+	switch (compression) {
+		case Compression::NONE:
+			return {};
+#ifdef STLENC_WITH_ZLIB
+		case Compression::GZIP:
+			return std::make_unique<GzipCompressor>(level);
+#endif
+#ifdef STLENC_WITH_ZSTD
+		case Compression::ZSTD:
+			return std::make_unique<ZstdCompressor>(level);
+#endif
+		default:
+			(void)level;
+			throw std::runtime_error("compression is not available in this build");
+	}
+}
+
+
+Compression parseCompression(const wchar_t* name, std::wstring& warnings) {
+	const auto c = std::find_if(std::begin(COMPRESSIONS), std::end(COMPRESSIONS), [name](const auto& p) {
+		return std::wcscmp(p.first, name) == 0;
+	});
+	if (c == std::end(COMPRESSIONS) || !Compressor::isAvailable(c->second)) {
+		warnings += L"compression '" + std::wstring(name) + L"' is not available, writing uncompressed output";
+		return Compression::NONE;
+	}
+	return c->second;
+}
+
+
+int clampCompressionLevel(Compression compression, int level, std::wstring& warnings) {
+	int minLevel = 1;
+	int maxLevel = 1;
+	switch (compression) {
+		case Compression::NONE:
+			return level; // ignored
+		case Compression::GZIP:
+			maxLevel = 9;
+			break;
+		case Compression::ZSTD:
+			maxLevel = 22;
+			break;
+	}
+	if (level == 0 || (level >= minLevel && level <= maxLevel))
+		return level;
+
+	const int clamped = std::clamp(level, minLevel, maxLevel);
+	warnings += L"compression level " + std::to_wstring(level) + L" is not supported by "
+	            + getCompressionName(compression) + L", using " + std::to_wstring(clamped);
+	return clamped;
+}
+
+
+const wchar_t* getCompressionName(Compression compression) {
+	const auto c = std::find_if(std::begin(COMPRESSIONS), std::end(COMPRESSIONS), [compression](const auto& p) {
+		return p.second == compression;
+	});
+	return (c != std::end(COMPRESSIONS)) ? c->first : L"";
+}
+
+
+bool Compressor::isAvailable(Compression compression) {
+	switch (compression) {
+		case Compression::NONE:
+			return true;
+		case Compression::GZIP:
+#ifdef STLENC_WITH_ZLIB
+			return true;
+#else
+			return false;
+#endif
+		case Compression::ZSTD:
+#ifdef STLENC_WITH_ZSTD
+			return true;
+#else
+			return false;
+#endif
+	}
+	return false;
+}
+
+
+std::wstring Compressor::getFileExtension(Compression compression) {
+	switch (compression) {
+		case Compression::GZIP:
+			return L".gz";
+		case Compression::ZSTD:
+			return L".zst";
+		default:
+			return {};
+	}
+}
+
+} // namespace stlenc
@@ -0,0 +1,67 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace stlenc {
+
+enum class Compression { NONE, GZIP, ZSTD };
+
+/**
+ * Returns the compression named by an encoder option value: 'none', 'gzip' or 'zstd'. Unknown compressions and
+ * compressions which are not available in this build fall back to NONE, with a message appended to warnings.
+ */
+Compression parseCompression(const wchar_t* name, std::wstring& warnings);
+
+/**
+ * Returns the level clamped to the levels of the compression (1-9 for gzip, 1-22 for zstd), with a message appended
+ * to warnings if it was out of range. 0 selects the default level of the compression and is kept.
+ */
+int clampCompressionLevel(Compression compression, int level, std::wstring& warnings);
+
+/// the option value of the compression, see parseCompression()
+const wchar_t* getCompressionName(Compression compression);
+
+/**
+ * Streaming compressor, the chunks passed to compress() form one continuous compressed stream.
+ * gzip and zstd support depends on the STLENC_WITH_ZLIB and STLENC_WITH_ZSTD build options.
+ */
+class Compressor {
+public:
+	/// returns nullptr for Compression::NONE, throws if the compression is not available in this build
+	static std::unique_ptr<Compressor> create(Compression compression, int level);
+	static bool isAvailable(Compression compression);
+	static std::wstring getFileExtension(Compression compression);
+
+	virtual ~Compressor() = default;
+
+	/// compresses size bytes of data and appends the result to out, finish terminates the stream
+	virtual void compress(const uint8_t* data, size_t size, bool finish, std::vector<uint8_t>& out) = 0;
+};
+
+} // namespace stlenc
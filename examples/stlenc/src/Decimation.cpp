@@ -0,0 +1,328 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Decimation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+
+namespace {
+
+constexpr double BOUNDARY_WEIGHT = 100.0; // relative weight of the quadrics which keep the borders in place
+
+using Vec3 = std::array<double, 3>;
+
+inline Vec3 sub(const Vec3& a, const Vec3& b) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+inline double dot(const Vec3& a, const Vec3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+	return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+}
+
+/**
+ * Symmetric 4x4 matrix of the squared distance to a set of planes.
+ */
+struct Quadric {
+	double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+	// plane n.p + d = 0 with unit normal n
+	static Quadric plane(const Vec3& n, double d, double weight) {
+		const double a = n[0], b = n[1], c = n[2];
+		return { weight * a * a, weight * a * b, weight * a * c, weight * a * d, weight * b * b, weight * b * c,
+		         weight * b * d, weight * c * c, weight * c * d, weight * d * d };
+	}
+
+	Quadric& operator+=(const Quadric& q) {
+		a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2;
+		bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2;
+		return *this;
+	}
+
+	double error(const Vec3& p) const {
+		const double x = p[0], y = p[1], z = p[2];
+		return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+		       + c2 * z * z + 2 * cd * z + d2;
+	}
+};
+
+struct Collapse {
+	double   cost;
+	uint32_t a, b;
+	uint32_t stampA, stampB; // the collapse is outdated if one of the vertices changed since
+	Vec3     position;
+
+	bool operator>(const Collapse& c) const { return cost > c.cost; }
+};
+
+using CollapseQueue = std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>>;
+
+inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+	return (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+struct PositionHash {
+	size_t operator()(const Vec3& p) const {
+		uint64_t h = 0;
+		for (double v: p) {
+			uint64_t bits = 0; // -0.0 == 0.0, so both must hash alike (v + 0.0 does not survive -ffast-math)
+			if (v != 0.0)
+				std::memcpy(&bits, &v, sizeof(bits));
+			h = (h ^ bits) * 0x9E3779B97F4A7C15ull;
+		}
+		return static_cast<size_t>(h ^ (h >> 32));
+	}
+};
+
+class Decimator {
+public:
+	Decimator(const double* vertexCoords, const uint32_t* triangles, size_t triangleCount) {
+		weld(vertexCoords, triangles, triangleCount);
+		computeQuadrics();
+	}
+
+	stlenc::TriangleMesh run(size_t targetTriangleCount);
+
+private:
+	std::vector<Vec3>                    mPositions;
+	std::vector<std::array<uint32_t, 3>> mTriangles;
+	std::vector<bool>                    mTriangleAlive;
+	std::vector<Quadric>                 mQuadrics;
+	std::vector<std::vector<uint32_t>>   mVertexTriangles;
+	std::vector<uint32_t>                mStamps;
+	std::vector<bool>                    mVertexAlive;
+	size_t                               mAliveCount = 0;
+
+	void weld(const double* vertexCoords, const uint32_t* triangles, size_t triangleCount);
+	void computeQuadrics();
+	Collapse evaluate(uint32_t a, uint32_t b) const;
+	bool flips(uint32_t a, uint32_t b, const Vec3& position) const;
+	void collapse(const Collapse& c);
+	void pushCollapses(uint32_t v, CollapseQueue& queue, bool initial) const;
+};
+
+
+void Decimator::weld(const double* vertexCoords, const uint32_t* triangles, size_t triangleCount) {
+	std::unordered_map<Vec3, uint32_t, PositionHash> ids;
+	std::unordered_map<uint32_t, uint32_t> remap;
+	auto id = [&](uint32_t vi) {
+		const auto r = remap.find(vi);
+		if (r != remap.end())
+			return r->second;
+		const Vec3 p = { vertexCoords[3 * size_t(vi)], vertexCoords[3 * size_t(vi) + 1], vertexCoords[3 * size_t(vi) + 2] };
+		const auto it = ids.emplace(p, static_cast<uint32_t>(mPositions.size())).first;
+		if (it->second == mPositions.size())
+			mPositions.push_back(p);
+		remap.emplace(vi, it->second);
+		return it->second;
+	};
+
+	mTriangles.reserve(triangleCount);
+	for (size_t t = 0; t < triangleCount; t++) {
+		const std::array<uint32_t, 3> tri = { id(triangles[3 * t]), id(triangles[3 * t + 1]), id(triangles[3 * t + 2]) };
+		if (tri[0] != tri[1] && tri[1] != tri[2] && tri[0] != tri[2])
+			mTriangles.push_back(tri);
+	}
+	mTriangleAlive.assign(mTriangles.size(), true);
+	mAliveCount = mTriangles.size();
+
+	mVertexTriangles.resize(mPositions.size());
+	for (uint32_t t = 0; t < mTriangles.size(); t++) {
+		for (uint32_t v: mTriangles[t])
+			mVertexTriangles[v].push_back(t);
+	}
+	mStamps.assign(mPositions.size(), 0);
+	mVertexAlive.assign(mPositions.size(), true);
+}
+
+
+void Decimator::computeQuadrics() {
+	mQuadrics.assign(mPositions.size(), Quadric());
+
+	std::unordered_map<uint64_t, uint32_t> edgeUse;
+	for (const auto& tri: mTriangles) {
+		for (int e = 0; e < 3; e++)
+			edgeUse[edgeKey(tri[e], tri[(e + 1) % 3])]++;
+	}
+
+	for (const auto& tri: mTriangles) {
+		const Vec3& p0 = mPositions[tri[0]];
+		Vec3 n = cross(sub(mPositions[tri[1]], p0), sub(mPositions[tri[2]], p0));
+		const double len = std::sqrt(dot(n, n));
+		if (len == 0.0)
+			continue;
+		n = { n[0] / len, n[1] / len, n[2] / len };
+		const double area = 0.5 * len;
+		const Quadric q = Quadric::plane(n, -dot(n, p0), area);
+		for (uint32_t v: tri)
+			mQuadrics[v] += q;
+
+		// a plane through each border edge, perpendicular to the triangle
+		for (int e = 0; e < 3; e++) {
+			const uint32_t a = tri[e], b = tri[(e + 1) % 3];
+			if (edgeUse[edgeKey(a, b)] != 1)
+				continue;
+			const Vec3 edge = sub(mPositions[b], mPositions[a]);
+			Vec3 bn = cross(edge, n);
+			const double bl = std::sqrt(dot(bn, bn));
+			if (bl == 0.0)
+				continue;
+			bn = { bn[0] / bl, bn[1] / bl, bn[2] / bl };
+			const Quadric bq = Quadric::plane(bn, -dot(bn, mPositions[a]), BOUNDARY_WEIGHT * dot(edge, edge));
+			mQuadrics[a] += bq;
+			mQuadrics[b] += bq;
+		}
+	}
+}
+
+
+Collapse Decimator::evaluate(uint32_t a, uint32_t b) const {
+	Quadric q = mQuadrics[a];
+	q += mQuadrics[b];
+
+	// the cheapest of both end points and the midpoint
+	const Vec3& pa = mPositions[a];
+	const Vec3& pb = mPositions[b];
+	const Vec3 candidates[3] = { pa, pb, { 0.5 * (pa[0] + pb[0]), 0.5 * (pa[1] + pb[1]), 0.5 * (pa[2] + pb[2]) } };
+	Collapse c = { q.error(candidates[0]), a, b, mStamps[a], mStamps[b], candidates[0] };
+	for (int i = 1; i < 3; i++) {
+		const double cost = q.error(candidates[i]);
+		if (cost < c.cost) {
+			c.cost = cost;
+			c.position = candidates[i];
+		}
+	}
+	return c;
+}
+
+
+bool Decimator::flips(uint32_t a, uint32_t b, const Vec3& position) const {
+	for (uint32_t v: { a, b }) {
+		for (uint32_t t: mVertexTriangles[v]) {
+			if (!mTriangleAlive[t])
+				continue;
+			const auto& tri = mTriangles[t];
+			if (std::find(tri.begin(), tri.end(), a) != tri.end() && std::find(tri.begin(), tri.end(), b) != tri.end())
+				continue; // removed by the collapse
+
+			Vec3 p[3], q[3];
+			for (int i = 0; i < 3; i++) {
+				p[i] = mPositions[tri[i]];
+				q[i] = (tri[i] == v) ? position : p[i];
+			}
+			const Vec3 before = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+			const Vec3 after = cross(sub(q[1], q[0]), sub(q[2], q[0]));
+			if (dot(before, after) <= 0.0)
+				return true;
+		}
+	}
+	return false;
+}
+
+
+void Decimator::collapse(const Collapse& c) {
+	const uint32_t a = c.a, b = c.b;
+	mPositions[a] = c.position;
+	mQuadrics[a] += mQuadrics[b];
+
+	for (uint32_t t: mVertexTriangles[b]) {
+		if (!mTriangleAlive[t])
+			continue;
+		auto& tri = mTriangles[t];
+		if (std::find(tri.begin(), tri.end(), a) != tri.end()) {
+			mTriangleAlive[t] = false;
+			mAliveCount--;
+		}
+		else {
+			std::replace(tri.begin(), tri.end(), b, a);
+			mVertexTriangles[a].push_back(t);
+		}
+	}
+
+	std::vector<uint32_t>& at = mVertexTriangles[a];
+	at.erase(std::remove_if(at.begin(), at.end(), [this](uint32_t t) { return !mTriangleAlive[t]; }), at.end());
+	mVertexTriangles[b].clear();
+	mVertexAlive[b] = false;
+	mStamps[a]++;
+}
+
+
+// all collapses of edges from v, initially only of those to vertices with a higher index, so each edge is added once
+void Decimator::pushCollapses(uint32_t v, CollapseQueue& queue, bool initial) const {
+	for (uint32_t t: mVertexTriangles[v]) {
+		for (uint32_t n: mTriangles[t]) {
+			if (initial ? (n > v) : (n != v))
+				queue.push(evaluate(v, n));
+		}
+	}
+}
+
+
+stlenc::TriangleMesh Decimator::run(size_t targetTriangleCount) {
+	CollapseQueue queue;
+	for (uint32_t v = 0; v < mPositions.size(); v++)
+		pushCollapses(v, queue, true);
+
+	while (mAliveCount > targetTriangleCount && !queue.empty()) {
+		const Collapse c = queue.top();
+		queue.pop();
+		if (!mVertexAlive[c.a] || !mVertexAlive[c.b] || mStamps[c.a] != c.stampA || mStamps[c.b] != c.stampB)
+			continue; // outdated
+		if (flips(c.a, c.b, c.position))
+			continue;
+
+		collapse(c);
+		pushCollapses(c.a, queue, false);
+	}
+
+	// compact the remaining vertices and triangles
+	stlenc::TriangleMesh result;
+	std::vector<uint32_t> index(mPositions.size(), UINT32_MAX);
+	for (uint32_t t = 0; t < mTriangles.size(); t++) {
+		if (!mTriangleAlive[t])
+			continue;
+		for (uint32_t v: mTriangles[t]) {
+			if (index[v] == UINT32_MAX) {
+				index[v] = static_cast<uint32_t>(result.vertexCoords.size() / 3);
+				result.vertexCoords.insert(result.vertexCoords.end(), mPositions[v].begin(), mPositions[v].end());
+			}
+			result.triangles.push_back(index[v]);
+		}
+	}
+	return result;
+}
+
+} // namespace
+
+
+namespace stlenc {
+
+TriangleMesh decimate(const double* vertexCoords, const uint32_t* triangles, size_t triangleCount, double ratio) {
+	Decimator decimator(vertexCoords, triangles, triangleCount);
+	const size_t target = static_cast<size_t>(std::llround(std::clamp(ratio, 0.0, 1.0) * triangleCount));
+	return decimator.run(target);
+}
+
+} // namespace stlenc
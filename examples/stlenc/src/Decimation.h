@@ -0,0 +1,49 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+
+namespace stlenc {
+
+/**
+ * Triangle mesh with shared vertices: 3 coordinates per vertex and 3 vertex indices per triangle.
+ */
+struct TriangleMesh {
+	std::vector<double>   vertexCoords;
+	std::vector<uint32_t> triangles;
+
+	size_t getTriangleCount() const { return triangles.size() / 3; }
+};
+
+/**
+ * Reduces a triangle mesh to about ratio times its triangle count by quadric error edge collapses
+ * (Garland and Heckbert). Coincident vertices are welded first, so unindexed triangle soups work as well.
+ * Mesh borders are kept in place by additional boundary quadrics, collapses which would flip a triangle are skipped.
+ */
+TriangleMesh decimate(const double* vertexCoords, const uint32_t* triangles, size_t triangleCount, double ratio);
+
+} // namespace stlenc
@@ -0,0 +1,160 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "ChunkedOutput.h"
+#include "STLFormat.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <atomic>
+#include <vector>
+
+
+namespace stlenc {
+
+constexpr uint32_t FACET_BLOCK_SIZE  = 4096; // facets gathered and formatted at once
+constexpr size_t   BLOCKS_PER_WORKER = 4;    // blocks formatted by each thread before the results are written
+
+/**
+ * Per-thread temporary buffers for gathering and converting facets.
+ */
+struct FacetScratch {
+	FacetTile             tile;
+	std::vector<uint32_t> indices;
+	std::vector<float>    floats;
+};
+
+/**
+ * Gathers the (triangulated) faces of a block into the facet tile of the scratch buffers. The mesh accessors are only
+ * called in a compact pass over the face indices, the coordinates are then gathered component by component.
+ * The first vertex normal is used as face normal, unless computeNormals is set (e.g. the encode preparator was told
+ * to skip normal processing), then the facet normals are computed from the vertices.
+ * Transformed blocks (instances) are transformed here and always get computed normals.
+ * Block provides mesh (with the accessors of prtx::Mesh), faceBegin, faceEnd, transform and flipWinding.
+ */
+template <typename Block>
+void gatherFacets(const Block& block, bool computeNormals, FacetScratch& scratch) {
+	const auto& m = *block.mesh;
+	const size_t n = block.faceEnd - block.faceBegin;
+	computeNormals = computeNormals || block.transform != nullptr;
+	const int v1 = block.flipWinding ? 2 : 1;
+	const int v2 = block.flipWinding ? 1 : 2;
+
+	// the vertex indices of the three corners and the normal indices, one array each
+	scratch.indices.resize(4 * n);
+	uint32_t* const indices = scratch.indices.data();
+	for (size_t f = 0; f < n; f++) {
+		const uint32_t fi = block.faceBegin + static_cast<uint32_t>(f);
+		assert(m.getFaceVertexCount(fi) == 3); // the meshes are triangulated
+		const uint32_t* fvi = m.getFaceVertexIndices(fi);
+		indices[f] = fvi[0];
+		indices[n + f] = fvi[v1];
+		indices[2 * n + f] = fvi[v2];
+		if (!computeNormals)
+			indices[3 * n + f] = m.getFaceVertexNormalIndices(fi)[0];
+	}
+
+	FacetTile& tile = scratch.tile;
+	tile.resize(n);
+	const double* vc = m.getVertexCoords().data();
+	for (size_t v = 0; v < 3; v++)
+		gatherPoints(tile, FacetTile::vertex(v), vc, indices + v * n);
+
+	if (block.transform != nullptr)
+		transformFacets(tile, block.transform);
+	if (computeNormals)
+		computeFacetNormals(tile);
+	else
+		gatherPoints(tile, FacetTile::NORMAL, m.getVertexNormalsCoords().data(), indices + 3 * n);
+}
+
+/**
+ * Number of pool threads worth using for blockCount blocks: each thread gets at least BLOCKS_PER_WORKER blocks.
+ */
+inline unsigned getUsefulThreadCount(size_t blockCount, const WorkerPool& pool) {
+	const size_t useful = (blockCount + BLOCKS_PER_WORKER - 1) / BLOCKS_PER_WORKER;
+	return static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(pool.getThreadCount(), useful)));
+}
+
+/**
+ * Formats all blocks with formatBlock(block, buffer, scratch) and writes the results in block order.
+ * The blocks are processed in batches: each thread formats a contiguous range of the batch into its own buffer,
+ * then the buffers are appended to the output in order, so the result does not depend on the thread count.
+ */
+template <typename Block, typename F>
+void formatBlocks(const std::vector<Block>& blocks, WorkerPool& pool, ChunkedOutput& out, F formatBlock) {
+	struct Worker {
+		std::vector<uint8_t> buffer;
+		FacetScratch         scratch;
+	};
+
+	const unsigned threadCount = getUsefulThreadCount(blocks.size(), pool);
+	if (threadCount <= 1) {
+		Worker w;
+		for (const Block& block: blocks) {
+			formatBlock(block, out.getBuffer(), w.scratch);
+			out.commit();
+		}
+		return;
+	}
+
+	std::vector<Worker> workers(threadCount);
+	const size_t batchSize = threadCount * BLOCKS_PER_WORKER;
+	for (size_t batchBegin = 0; batchBegin < blocks.size(); batchBegin += batchSize) {
+		const size_t batchEnd = std::min(blocks.size(), batchBegin + batchSize);
+		pool.run(threadCount, [&](unsigned wi) {
+			Worker& w = workers[wi];
+			w.buffer.clear();
+			const size_t begin = std::min(batchEnd, batchBegin + wi * BLOCKS_PER_WORKER);
+			const size_t end = std::min(batchEnd, begin + BLOCKS_PER_WORKER);
+			for (size_t bi = begin; bi < end; bi++)
+				formatBlock(blocks[bi], w.buffer, w.scratch);
+		});
+
+		for (const Worker& w: workers)
+			out.append(w.buffer.data(), w.buffer.size());
+	}
+}
+
+/**
+ * Formats all blocks with formatBlock(blockIndex, scratch) on the pool, for output of known layout where each
+ * block is written to its own location (e.g. binary STL in a mapped file), so no ordering is needed.
+ * The threads take BLOCKS_PER_WORKER blocks at a time, which balances blocks of different sizes.
+ */
+template <typename F>
+void formatBlocksInPlace(size_t blockCount, WorkerPool& pool, F formatBlock) {
+	std::atomic<size_t> next(0);
+	pool.run(getUsefulThreadCount(blockCount, pool), [&](unsigned) {
+		FacetScratch scratch;
+		for (size_t begin = next.fetch_add(BLOCKS_PER_WORKER); begin < blockCount;
+		     begin = next.fetch_add(BLOCKS_PER_WORKER)) {
+			const size_t end = std::min(blockCount, begin + BLOCKS_PER_WORKER);
+			for (size_t bi = begin; bi < end; bi++)
+				formatBlock(bi, scratch);
+		}
+	});
+}
+
+} // namespace stlenc
@@ -0,0 +1,107 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <cerrno>
+#	include <cstring>
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
+
+
+namespace stlenc {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path, uint64_t size) : mSize(size) {
+	mFile = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+	                    nullptr);
+	if (mFile == INVALID_HANDLE_VALUE) {
+		mFile = nullptr;
+		throw std::runtime_error("cannot create " + path.string());
+	}
+
+	// creating the mapping extends the file to its final size
+	const DWORD sizeHigh = static_cast<DWORD>(size >> 32);
+	const DWORD sizeLow = static_cast<DWORD>(size & 0xFFFFFFFFu);
+	mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READWRITE, sizeHigh, sizeLow, nullptr);
+	if (mMapping != nullptr)
+		mData = static_cast<uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_WRITE, 0, 0, size));
+	if (mData == nullptr) {
+		if (mMapping != nullptr)
+			CloseHandle(mMapping);
+		CloseHandle(mFile);
+		throw std::runtime_error("cannot map " + path.string());
+	}
+}
+
+
+MappedFile::~MappedFile() {
+	UnmapViewOfFile(mData);
+	CloseHandle(mMapping);
+	CloseHandle(mFile);
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path, uint64_t size) : mSize(size) {
+	mFile = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (mFile < 0)
+		throw std::runtime_error("cannot create " + path.string() + ": " + std::strerror(errno));
+
+	// allocate the blocks up front, so a full disk is reported here instead of by SIGBUS while writing
+#ifdef __linux__
+	const int error = posix_fallocate(mFile, 0, static_cast<off_t>(size));
+#else
+	const int error = (ftruncate(mFile, static_cast<off_t>(size)) == 0) ? 0 : errno;
+#endif
+	if (error == 0 && size > 0) {
+		void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mFile, 0);
+		mData = (data != MAP_FAILED) ? static_cast<uint8_t*>(data) : nullptr;
+	}
+	if (error != 0 || (mData == nullptr && size > 0)) {
+		const std::string reason = std::strerror(error != 0 ? error : errno);
+		close(mFile);
+		throw std::runtime_error("cannot map " + path.string() + ": " + reason);
+	}
+}
+
+
+MappedFile::~MappedFile() {
+	if (mData != nullptr)
+		munmap(mData, mSize);
+	close(mFile);
+}
+
+#endif
+
+} // namespace stlenc
@@ -0,0 +1,58 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+
+namespace stlenc {
+
+/**
+ * A local file of a fixed size, created (or truncated) and mapped into memory for writing.
+ * The mapping is written back and closed by the destructor. Throws std::runtime_error if the file cannot be
+ * created, sized or mapped, e.g. for a missing directory or insufficient disk space.
+ */
+class MappedFile {
+public:
+	MappedFile(const std::filesystem::path& path, uint64_t size);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&&) = delete;
+	MappedFile& operator=(MappedFile&) = delete;
+	~MappedFile();
+
+	uint8_t* data() { return mData; }
+	uint64_t size() const { return mSize; }
+
+private:
+	uint8_t* mData = nullptr;
+	uint64_t mSize = 0;
+#ifdef _WIN32
+	void*    mFile = nullptr;
+	void*    mMapping = nullptr;
+#else
+	int      mFile = -1;
+#endif
+};
+
+} // namespace stlenc
@@ -0,0 +1,126 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OutputCache.h"
+
+#include <cstring>
+
+
+namespace stlenc {
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+	// multiplicative mixing of 8 byte words, the tail is zero-padded
+	constexpr uint64_t K = 0x9E3779B97F4A7C15ull;
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	uint64_t h = seed ^ (size * K);
+	for (; size >= 8; p += 8, size -= 8) {
+		uint64_t w;
+		std::memcpy(&w, p, 8);
+		h = (h ^ w) * K;
+		h ^= h >> 29;
+	}
+	if (size > 0) {
+		uint64_t w = 0;
+		std::memcpy(&w, p, size);
+		h = (h ^ w) * K;
+		h ^= h >> 29;
+	}
+	return h;
+}
+
+
+OutputCache& OutputCache::instance() {
+	static OutputCache cache;
+	return cache;
+}
+
+
+void OutputCache::setCapacity(size_t capacity) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	mCapacity = capacity;
+	evict();
+}
+
+
+bool OutputCache::isEnabled() const {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCapacity > 0;
+}
+
+
+OutputCache::Bytes OutputCache::get(uint64_t hash, const Key& key) {
+	EntryPtr entry;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		const auto it = mIndex.find(hash);
+		if (it != mIndex.end()) {
+			entry = *it->second;
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+		}
+	}
+	if (!entry || entry->key != key) {
+		mMisses++;
+		return {};
+	}
+	mHits++;
+	return entry->bytes;
+}
+
+
+void OutputCache::put(uint64_t hash, Key key, Bytes bytes) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (key.size() + bytes->size() > mCapacity)
+		return;
+
+	const auto it = mIndex.find(hash);
+	if (it != mIndex.end()) { // the same key or a collision, keep the latest entry
+		mSize -= (*it->second)->size();
+		mEntries.erase(it->second);
+		mIndex.erase(it);
+	}
+	mEntries.push_front(std::make_shared<const Entry>(Entry{ hash, std::move(key), std::move(bytes) }));
+	mSize += mEntries.front()->size();
+	mIndex.emplace(hash, mEntries.begin());
+	evict();
+}
+
+
+uint64_t OutputCache::getHits() const {
+	return mHits;
+}
+
+
+uint64_t OutputCache::getMisses() const {
+	return mMisses;
+}
+
+
+void OutputCache::evict() {
+	while (mSize > mCapacity) {
+		const Entry& lru = *mEntries.back();
+		mSize -= lru.size();
+		mIndex.erase(lru.hash);
+		mEntries.pop_back();
+	}
+}
+
+} // namespace stlenc
@@ -0,0 +1,86 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace stlenc {
+
+/// hashes size bytes, continuing from seed (e.g. the hash of preceding data)
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+/**
+ * Process-wide least-recently-used cache of formatted output, keyed by the formatted geometry and the output
+ * settings. It survives across generate calls, so unchanged geometry is not formatted again when it is re-exported.
+ * Entries are found by a hash of the key, and the key itself is stored and compared, so hash collisions are misses.
+ * All methods are thread-safe, the keys are compared outside of the lock.
+ */
+class OutputCache {
+public:
+	using Key = std::vector<uint8_t>;
+	using Bytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+	static OutputCache& instance();
+
+	/// sets the maximum size of all cached keys and entries in bytes, 0 disables caching and releases all entries
+	void setCapacity(size_t capacity);
+	bool isEnabled() const;
+
+	/// hash is hashBytes() of key
+	Bytes get(uint64_t hash, const Key& key);
+	void put(uint64_t hash, Key key, Bytes bytes);
+
+	uint64_t getHits() const;
+	uint64_t getMisses() const;
+
+private:
+	struct Entry {
+		uint64_t hash;
+		Key      key;
+		Bytes    bytes;
+
+		size_t size() const { return key.size() + bytes->size(); }
+	};
+	using EntryPtr = std::shared_ptr<const Entry>; // shared with get() while the key is compared
+
+	OutputCache() = default;
+	void evict(); // requires mMutex
+
+	mutable std::mutex                                           mMutex;
+	std::list<EntryPtr>                                          mEntries; // most recently used first
+	std::unordered_map<uint64_t, std::list<EntryPtr>::iterator> mIndex;
+	size_t                                                       mCapacity = 0;
+	size_t                                                       mSize = 0;
+	std::atomic<uint64_t>                                        mHits{0};
+	std::atomic<uint64_t>                                        mMisses{0};
+};
+
+} // namespace stlenc
@@ -0,0 +1,260 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PLYEncoder.h"
+#include "STLFormat.h"
+#include "ChunkedOutput.h"
+
+#include "prtx/Shape.h"
+#include "prtx/ShapeIterator.h"
+#include "prtx/GenerateContext.h"
+#include "prtx/Geometry.h"
+#include "prtx/Mesh.h"
+#include "prtx/EncodeOptions.h"
+#include "prtx/EncoderInfoBuilder.h"
+
+#include "prt/API.h"
+
+#include <cassert>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+#include <limits>
+
+
+namespace {
+
+const wchar_t*     EO_BASE_NAME       = L"baseName";
+const wchar_t*     EO_ERROR_FALLBACK  = L"errorFallback";
+const wchar_t*     EO_COMPRESSION     = L"compression";
+const wchar_t*     EO_COMPRESSION_LVL = L"compressionLevel";
+const wchar_t*     EO_ASYNC_WRITES    = L"asyncWrites";
+const std::wstring PLY_EXT            = L".ply";
+
+constexpr size_t   WRITER_BUFFERS     = 4;
+constexpr size_t   VERTEX_BLOCK_SIZE  = 4096; // vertices converted to float at once
+constexpr size_t   FACE_RECORD_SIZE   = 1 + 3 * sizeof(uint32_t); // uchar count and three uint indices
+
+// PLY keeps the merged vertices, so mergeVertices and indexed output is what makes it smaller than STL
+const prtx::EncodePreparator::PreparationFlags ENC_PREP_FLAGS = prtx::EncodePreparator::PreparationFlags()
+	.instancing(false)
+	.meshMerging(prtx::MeshMerging::ALL_OF_SAME_MATERIAL_AND_TYPE)
+	.triangulate(true)
+	.mergeVertices(true)
+	.cleanupVertexNormals(false)
+	.cleanupUVs(false)
+	.processVertexNormals(prtx::VertexNormalProcessor::PASS);
+
+} // namespace
+
+
+const std::wstring PLYEncoder::ID          = L"com.esri.prt.examples.PLYEncoder";
+const std::wstring PLYEncoder::NAME        = L"PLY Encoder";
+const std::wstring PLYEncoder::DESCRIPTION = L"Example encoder for the binary PLY format";
+
+
+/**
+ * Setup two namespaces for mesh and material objects and initialize the encode preprator.
+ * The namespaces are used to create unique names for all mesh and material objects.
+ */
+void PLYEncoder::init(prtx::GenerateContext& /*context*/) {
+	mNamespaceMaterials = mNamePreparator.newNamespace();
+	mNamespaceMeshes = mNamePreparator.newNamespace();
+	mEncodePreparator = prtx::EncodePreparator::create(true, mNamePreparator, mNamespaceMeshes, mNamespaceMaterials);
+
+	std::wstring warnings;
+	mCompression = stlenc::parseCompression(getOptions()->getString(EO_COMPRESSION), warnings);
+	if (!warnings.empty())
+		prt::log((L"PLY Encoder: " + warnings).c_str(), prt::LOG_WARNING);
+	warnings.clear();
+	mCompressionLevel = stlenc::clampCompressionLevel(mCompression, getOptions()->getInt(EO_COMPRESSION_LVL), warnings);
+	if (!warnings.empty())
+		prt::log((L"PLY Encoder: " + warnings).c_str(), prt::LOG_WARNING);
+	mAsyncWrites = getOptions()->getBool(EO_ASYNC_WRITES);
+}
+
+
+/**
+ * During encoding we collect the resulting shapes with the encode preparator.
+ * In case the shape generation fails, we collect the initial shape.
+ */
+void PLYEncoder::encode(prtx::GenerateContext& context, size_t initialShapeIndex) {
+	const prtx::InitialShape* is = context.getInitialShape(initialShapeIndex);
+	try {
+		const prtx::LeafIteratorPtr li = prtx::LeafIterator::create(context, initialShapeIndex);
+		for (prtx::ShapePtr shape = li->getNext(); shape.get() != nullptr; shape = li->getNext())
+			mEncodePreparator->add(context.getCache(), shape, is->getAttributeMap());
+	} catch(...) {
+		mEncodePreparator->add(context.getCache(), *is, initialShapeIndex);
+	}
+}
+
+
+/**
+ * After all shapes have been generated, the PLY header needs the vertex and face counts up front, so the
+ * geometry is finalized at once and then streamed to the file: the vertices of all meshes, then the faces with
+ * their indices moved by the number of vertices of the preceding meshes.
+ */
+void PLYEncoder::finish(prtx::GenerateContext& /*context*/) {
+	std::vector<prtx::EncodePreparator::FinalizedInstance> finalizedInstances;
+	mEncodePreparator->fetchFinalizedInstances(finalizedInstances, ENC_PREP_FLAGS);
+
+	uint64_t vertexCount = 0;
+	uint64_t faceCount = 0;
+	for (const auto& instance: finalizedInstances) {
+		for (const prtx::MeshPtr& m: instance.getGeometry()->getMeshes()) {
+			vertexCount += m->getVertexCoords().size() / 3;
+			faceCount += m->getFaceCount();
+		}
+	}
+	if (vertexCount > std::numeric_limits<uint32_t>::max()) {
+		prt::log(L"PLY Encoder: too many vertices for 32 bit vertex indices, nothing written", prt::LOG_ERROR);
+		return;
+	}
+
+	std::ostringstream header;
+	header << "ply\n"
+	       << "format binary_little_endian 1.0\n"
+	       << "comment written by the CityEngine SDK PLY Encoder example\n"
+	       << "element vertex " << vertexCount << "\n"
+	       << "property float x\n"
+	       << "property float y\n"
+	       << "property float z\n"
+	       << "element face " << faceCount << "\n"
+	       << "property list uchar uint vertex_indices\n"
+	       << "end_header\n";
+
+	// let the client application write the file via callback, in chunks of bounded size like the STL encoder
+	// the compressor is created first, so a failure does not leave an open file behind
+	prt::SimpleOutputCallbacks* soh = dynamic_cast<prt::SimpleOutputCallbacks*>(getCallbacks());
+	std::unique_ptr<stlenc::Compressor> compressor = stlenc::Compressor::create(mCompression, mCompressionLevel);
+	const std::wstring fileName = getOptions()->getString(EO_BASE_NAME) + PLY_EXT
+	                              + stlenc::Compressor::getFileExtension(mCompression);
+	const uint64_t handle = soh->open(ID.c_str(), prt::CT_GEOMETRY, fileName.c_str());
+	{
+		stlenc::ChunkedOutput output(soh, handle, std::move(compressor), mAsyncWrites ? WRITER_BUFFERS : 0);
+		output.append(header.str());
+		writeVertices(finalizedInstances, output);
+		writeFaces(finalizedInstances, output);
+		output.finish();
+	}
+	soh->close(handle, 0, 0);
+}
+
+
+/**
+ * One packed record of three float32 per vertex, converted from double in blocks.
+ */
+void PLYEncoder::writeVertices(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+                               stlenc::ChunkedOutput& output) const {
+	std::vector<float> floats(3 * VERTEX_BLOCK_SIZE);
+	for (const auto& instance: finalizedInstances) {
+		for (const prtx::MeshPtr& m: instance.getGeometry()->getMeshes()) {
+			const prtx::DoubleVector& vc = m->getVertexCoords();
+			for (size_t vb = 0; vb < vc.size(); vb += floats.size()) {
+				const size_t n = std::min(floats.size(), vc.size() - vb);
+				stlenc::convertToFloat(vc.data() + vb, floats.data(), n);
+				output.append(reinterpret_cast<const uint8_t*>(floats.data()), n * sizeof(float));
+			}
+		}
+	}
+}
+
+
+/**
+ * One packed record per triangle: the vertex count 3 as uchar, followed by the three uint32 vertex indices.
+ */
+void PLYEncoder::writeFaces(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+                            stlenc::ChunkedOutput& output) const {
+	uint32_t firstVertex = 0;
+	for (const auto& instance: finalizedInstances) {
+		for (const prtx::MeshPtr& m: instance.getGeometry()->getMeshes()) {
+			for (uint32_t fi = 0; fi < m->getFaceCount(); fi++) {
+				assert(m->getFaceVertexCount(fi) == 3); // we enabled triangulation above
+				const uint32_t* fvi = m->getFaceVertexIndices(fi);
+				const uint32_t indices[3] = { firstVertex + fvi[0], firstVertex + fvi[1], firstVertex + fvi[2] };
+
+				std::vector<uint8_t>& buffer = output.getBuffer();
+				const size_t offset = buffer.size();
+				buffer.resize(offset + FACE_RECORD_SIZE);
+				buffer[offset] = 3;
+				std::memcpy(buffer.data() + offset + 1, indices, sizeof(indices));
+				output.commit();
+			}
+			firstVertex += static_cast<uint32_t>(m->getVertexCoords().size() / 3);
+		}
+	}
+}
+
+
+/**
+ * Create the PLY encoder factory singleton and define the default options.
+ */
+PLYEncoderFactory* PLYEncoderFactory::createInstance() {
+	prtx::EncoderInfoBuilder encoderInfoBuilder;
+
+	encoderInfoBuilder.setID(PLYEncoder::ID);
+	encoderInfoBuilder.setName(PLYEncoder::NAME);
+	encoderInfoBuilder.setDescription(PLYEncoder::DESCRIPTION);
+	encoderInfoBuilder.setType(prt::CT_GEOMETRY);
+	encoderInfoBuilder.setExtension(PLY_EXT);
+
+	prtx::PRTUtils::AttributeMapBuilderPtr amb(prt::AttributeMapBuilder::create());
+	amb->setString(EO_BASE_NAME, L"ply_default_name"); // required by CityEngine
+	amb->setBool(EO_ERROR_FALLBACK, prtx::PRTX_TRUE); // required by CityEngine
+	amb->setString(EO_COMPRESSION, stlenc::getCompressionName(stlenc::Compression::NONE));
+	amb->setInt(EO_COMPRESSION_LVL, 0);
+	amb->setBool(EO_ASYNC_WRITES, prtx::PRTX_FALSE);
+	encoderInfoBuilder.setDefaultOptions(amb->createAttributeMap());
+
+	// CityEngine requires the following annotations to create an UI for an option:
+	// label, order, group and description
+	prtx::EncodeOptionsAnnotator eoa(encoderInfoBuilder);
+	eoa.option(EO_BASE_NAME)
+			.setLabel(L"Base Name")
+			.setOrder(0.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Sets the base name of the written PLY file.");
+
+	eoa.option(EO_COMPRESSION)
+			.setLabel(L"Compression")
+			.setOrder(1.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Compresses the output while writing: 'none', 'gzip' (.ply.gz) or 'zstd' (.ply.zst).");
+
+	eoa.option(EO_COMPRESSION_LVL)
+			.setLabel(L"Compression Level")
+			.setOrder(2.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Compression level of gzip (1-9) or zstd (1-22), 0 uses the default level.");
+
+	eoa.option(EO_ASYNC_WRITES)
+			.setLabel(L"Asynchronous Writes")
+			.setOrder(3.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Compresses and writes the output on a separate thread, overlapping slow storage with formatting.");
+
+	// Hide the error fallback option in the CityEngine UI.
+	eoa.option(EO_ERROR_FALLBACK).flagAsHidden();
+
+	return new PLYEncoderFactory(encoderInfoBuilder.create());
+}
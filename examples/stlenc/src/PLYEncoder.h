@@ -0,0 +1,101 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "prtx/prtx.h"
+#include "prtx/Encoder.h"
+#include "prtx/EncodePreparator.h"
+#include "prtx/EncoderFactory.h"
+#include "prtx/Singleton.h"
+
+#include "Compression.h"
+
+#include "prt/AttributeMap.h"
+#include "prt/Callbacks.h"
+
+#include <string>
+#include <vector>
+
+
+// forward declare some classes to reduce header inclusion
+namespace prtx {
+class GenerateContext;
+}
+
+namespace stlenc {
+class ChunkedOutput;
+}
+
+/**
+ * Writes the generated geometry as a single indexed binary (little endian) PLY file: the merged vertices of the
+ * encode preparator followed by the triangles, both as packed records through the chunked output of the STL encoder.
+ */
+class PLYEncoder : public prtx::GeometryEncoder {
+public:
+	static const std::wstring ID;
+	static const std::wstring NAME;
+	static const std::wstring DESCRIPTION;
+
+	using prtx::GeometryEncoder::GeometryEncoder; // re-use parent constructor
+
+	PLYEncoder(const PLYEncoder&) = delete;
+	PLYEncoder(PLYEncoder&&) = delete;
+	PLYEncoder& operator=(PLYEncoder&) = delete;
+	virtual ~PLYEncoder() = default;
+
+	virtual void init(prtx::GenerateContext& context) override;
+	virtual void encode(prtx::GenerateContext& context, size_t initialShapeIndex) override;
+	virtual void finish(prtx::GenerateContext& context) override;
+
+private:
+	void writeVertices(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+	                   stlenc::ChunkedOutput& output) const;
+	void writeFaces(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+	                stlenc::ChunkedOutput& output) const;
+
+	prtx::DefaultNamePreparator        mNamePreparator;
+	prtx::NamePreparator::NamespacePtr mNamespaceMaterials;
+	prtx::NamePreparator::NamespacePtr mNamespaceMeshes;
+	prtx::EncodePreparatorPtr          mEncodePreparator;
+
+	stlenc::Compression mCompression = stlenc::Compression::NONE;
+	int32_t             mCompressionLevel = 0;
+	bool                mAsyncWrites = false;
+};
+
+
+class PLYEncoderFactory : public prtx::EncoderFactory, public prtx::Singleton<PLYEncoderFactory> {
+public:
+	static PLYEncoderFactory* createInstance();
+
+	PLYEncoderFactory(const prt::EncoderInfo* info) : prtx::EncoderFactory(info) { }
+	PLYEncoderFactory(const PLYEncoderFactory&) = delete;
+	PLYEncoderFactory(PLYEncoderFactory&&) = delete;
+	PLYEncoderFactory& operator=(PLYEncoderFactory&) = delete;
+	virtual ~PLYEncoderFactory() = default;
+
+	virtual PLYEncoder* create(const prt::AttributeMap* defaultOptions, prt::Callbacks* callbacks) const override {
+		return new PLYEncoder(getID(), defaultOptions, callbacks);
+	}
+
+};
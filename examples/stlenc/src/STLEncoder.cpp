@@ -24,6 +24,12 @@
  */
 
 #include "STLEncoder.h"
+#include "STLFormat.h"
+#include "ChunkedOutput.h"
+#include "FacetWriter.h"
+#include "OutputCache.h"
+#include "Decimation.h"
+#include "MappedFile.h"
 
 #include "prtx/Shape.h"
 #include "prtx/ShapeIterator.h"
@@ -33,16 +39,84 @@
 #include "prtx/EncodeOptions.h"
 #include "prtx/EncoderInfoBuilder.h"
 
-#include <sstream>
+#include "prt/API.h"
+
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cwctype>
+#include <sstream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <filesystem>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <string_view>
+#include <thread>
+
+
+/**
+ * A range of faces of one mesh, the unit of work for gathering and formatting.
+ * With instancing, the mesh belongs to a shared prototype and is written with the transformation of the instance.
+ */
+struct STLEncoder::FacetBlock {
+	const prtx::Mesh*     mesh;
+	uint32_t              faceBegin;
+	uint32_t              faceEnd;
+	const double*         transform = nullptr; // column-major 4x4, nullptr for identity
+	bool                  flipWinding = false; // the transformation mirrors, restore the facet orientation
+	const prtx::Material* material = nullptr;
+};
 
 
 namespace {
 
 const wchar_t*     EO_BASE_NAME      = L"baseName";
 const wchar_t*     EO_ERROR_FALLBACK = L"errorFallback";
+const wchar_t*     EO_FORMAT         = L"format";
+const wchar_t*     EO_PRECISION      = L"precision";
+const wchar_t*     EO_THREADS        = L"threads";
+const wchar_t*     EO_INCREMENTAL    = L"incremental";
+const wchar_t*     EO_FILE_PER_SHAPE = L"filePerInitialShape";
+const wchar_t*     EO_PREPARATION    = L"preparation";
+const wchar_t*     EO_INSTANCING     = L"instancing";
+const wchar_t*     EO_CACHE_SIZE     = L"cacheSize";
+const wchar_t*     EO_EMIT_STATS     = L"emitStats";
+const wchar_t*     EO_BATCH_SHAPES   = L"batchShapes";
+const wchar_t*     EO_BATCH_MEMORY   = L"batchMemory";
+const wchar_t*     EO_ASYNC_WRITES   = L"asyncWrites";
+const wchar_t*     EO_LOD_RATIOS     = L"lodRatios";
+const wchar_t*     EO_TILE_SIZE      = L"tileSize";
+const wchar_t*     EO_DEDUPLICATE    = L"deduplicate";
+const wchar_t*     EO_RECENTER       = L"recenter";
+const wchar_t*     EO_DIRECT_OUTPUT  = L"directOutputPath";
+const wchar_t*     EO_SOLID_PER_MATERIAL = L"solidPerMaterial";
+const wchar_t*     EO_MIN_FACET_AREA = L"minFacetArea";
+const std::wstring PREPARATION_FULL  = L"full";
+const std::wstring PREPARATION_FAST  = L"fast";
+const wchar_t*     EO_COMPRESSION    = L"compression";
+const wchar_t*     EO_COMPRESSION_LVL = L"compressionLevel";
+const std::wstring FORMAT_ASCII      = L"ascii";
+const std::wstring FORMAT_BINARY     = L"binary";
 const std::wstring STL_EXT           = L".stl";
-const wchar_t*     WNL               = L"\n";
+const std::wstring STATS_SUFFIX      = L"_stats.json";
+const std::wstring LOD_SUFFIX        = L"_lod";
+const std::wstring TILE_INFIX        = L"_tile_";
+const std::wstring TILE_INDEX_SUFFIX = L"_tiles.json";
+const std::wstring INSTANCES_SUFFIX  = L"_instances.json";
+const std::wstring ORIGIN_SUFFIX     = L"_origin.json";
+const std::wstring MATERIALS_SUFFIX  = L"_materials.json";
+const std::wstring DEFAULT_MATERIAL  = L"default";
+const std::string  BINARY_HEADER     = "binary STL written by the CityEngine SDK STL Encoder example";
+const std::string  BINARY_HEADER_RECENTERED = "CityEngine SDK STL Encoder, origin ";
+const size_t       WRITER_BUFFERS    = 4; // chunks in flight between formatting and the writer thread
+const size_t       MAX_OPEN_TILE_FILES = 16; // including levels of detail, each holds a chunk (and a writer thread)
+const std::wstring TILE_PART_INFIX   = L"_part";
 
 const prtx::EncodePreparator::PreparationFlags ENC_PREP_FLAGS = prtx::EncodePreparator::PreparationFlags()
 	.instancing(false)
@@ -53,6 +127,293 @@ const prtx::EncodePreparator::PreparationFlags ENC_PREP_FLAGS = prtx::EncodePrep
 	.cleanupUVs(true)
 	.processVertexNormals(prtx::VertexNormalProcessor::SET_ALL_TO_FACE_NORMALS);
 
+// skips the work which does not survive in an STL file, facet normals are computed while writing
+const prtx::EncodePreparator::PreparationFlags ENC_PREP_FLAGS_FAST = prtx::EncodePreparator::PreparationFlags()
+	.instancing(false)
+	.meshMerging(prtx::MeshMerging::ALL_OF_SAME_MATERIAL_AND_TYPE)
+	.triangulate(true)
+	.mergeVertices(false)
+	.cleanupVertexNormals(false)
+	.cleanupUVs(false)
+	.processVertexNormals(prtx::VertexNormalProcessor::PASS);
+
+using Clock = std::chrono::steady_clock;
+
+double millisecondsSince(Clock::time_point t0) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+const double IDENTITY[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+constexpr double NORMAL_TOLERANCE = 1e-6; // of the length of facet normals, see the minFacetArea option
+constexpr double DEDUP_TOLERANCE  = 1e-4; // grid of the local coordinates compared by deduplication, in scene units
+
+using FacetBlock = STLEncoder::FacetBlock;
+
+// sign of the determinant of the upper 3x3 part of a column-major 4x4 matrix
+bool isMirroring(const double* m) {
+	const double det = m[0] * (m[5] * m[10] - m[9] * m[6])
+	                 - m[4] * (m[1] * m[10] - m[9] * m[2])
+	                 + m[8] * (m[1] * m[6] - m[5] * m[2]);
+	return det < 0.0;
+}
+
+// the mesh to write in place of m, i.e. its decimated version for levels of detail
+const prtx::Mesh* resolveMesh(const prtx::MeshPtr& m, const STLEncoder::MeshSubstitutes* substitutes) {
+	return (substitutes != nullptr) ? substitutes->at(m.get()).get() : m.get();
+}
+
+/**
+ * Splits the meshes of the instances into facet blocks. If origin is given, it is subtracted after the
+ * transformation of each instance, the combined transformations are stored in transforms.
+ */
+std::vector<FacetBlock> collectFacetBlocks(
+		const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+		const STLEncoder::MeshSubstitutes* substitutes, const double* origin,
+		std::deque<std::array<double, 16>>& transforms) {
+	std::vector<FacetBlock> blocks;
+	for (const auto& instance: finalizedInstances) {
+		const prtx::DoubleVector& trafo = instance.getTransformation();
+		const bool identity = (trafo.size() != 16 || std::equal(trafo.begin(), trafo.end(), IDENTITY));
+		const double* transform = identity ? nullptr : trafo.data();
+		const bool flipWinding = !identity && isMirroring(transform);
+		if (origin != nullptr) {
+			std::array<double, 16>& recentered = transforms.emplace_back();
+			std::copy_n(identity ? IDENTITY : trafo.data(), 16, recentered.begin());
+			for (int c = 0; c < 3; c++)
+				recentered[12 + c] -= origin[c];
+			transform = recentered.data();
+		}
+		const prtx::MeshPtrVector& meshes = instance.getGeometry()->getMeshes();
+		const prtx::MaterialPtrVector& materials = instance.getMaterials();
+		for (size_t mi = 0; mi < meshes.size(); mi++) {
+			const prtx::Mesh* m = resolveMesh(meshes[mi], substitutes);
+			const prtx::Material* material = (mi < materials.size()) ? materials[mi].get() : nullptr;
+			for (uint32_t fb = 0, n = m->getFaceCount(); fb < n; fb += stlenc::FACET_BLOCK_SIZE) {
+				blocks.push_back({ m, fb, std::min(n, fb + stlenc::FACET_BLOCK_SIZE), transform, flipWinding,
+				                   material });
+			}
+		}
+	}
+	return blocks;
+}
+
+/**
+ * Replaces characters which are not allowed in file names on common platforms.
+ */
+std::wstring toFileName(std::wstring name) {
+	std::replace_if(name.begin(), name.end(), [](wchar_t c) {
+		return c < 32 || std::wstring_view(L"<>:\"/\\|?*").find(c) != std::wstring_view::npos;
+	}, L'_');
+	return name;
+}
+
+// file systems on Windows and macOS ignore the case, so "Lot" and "lot" must not share a file
+std::wstring toFileNameKey(std::wstring name) {
+	std::transform(name.begin(), name.end(), name.begin(), [](wchar_t c) { return std::towlower(c); });
+	return name;
+}
+
+// rough size of the geometry of a shape before preparation, to decide when to finalize a batch
+uint64_t estimateGeometrySize(const prtx::Shape& shape) {
+	uint64_t size = 0;
+	if (const prtx::GeometryPtr& geometry = shape.getGeometry()) {
+		for (const prtx::MeshPtr& m: geometry->getMeshes()) {
+			size += (m->getVertexCoords().size() + m->getVertexNormalsCoords().size()) * sizeof(double);
+			size += uint64_t(m->getFaceCount()) * 3 * sizeof(uint32_t);
+		}
+	}
+	return size;
+}
+
+uint64_t countFacets(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+                     const STLEncoder::MeshSubstitutes* substitutes = nullptr) {
+	uint64_t facetCount = 0;
+	for (const auto& instance: finalizedInstances) {
+		for (const prtx::MeshPtr& m: instance.getGeometry()->getMeshes())
+			facetCount += resolveMesh(m, substitutes)->getFaceCount();
+	}
+	return facetCount;
+}
+
+// axis-aligned bounding box of the (transformed) vertices of an instance, false if it has no vertices
+bool computeBounds(const prtx::EncodePreparator::FinalizedInstance& instance, double bmin[3], double bmax[3]) {
+	const prtx::DoubleVector& trafo = instance.getTransformation();
+	const double* m = (trafo.size() == 16) ? trafo.data() : IDENTITY;
+	std::fill_n(bmin, 3, std::numeric_limits<double>::max());
+	std::fill_n(bmax, 3, std::numeric_limits<double>::lowest());
+	bool empty = true;
+	for (const prtx::MeshPtr& mesh: instance.getGeometry()->getMeshes()) {
+		const prtx::DoubleVector& coords = mesh->getVertexCoords();
+		for (size_t v = 0; v + 2 < coords.size(); v += 3) {
+			for (int c = 0; c < 3; c++) {
+				const double p = m[c] * coords[v] + m[4 + c] * coords[v + 1] + m[8 + c] * coords[v + 2] + m[12 + c];
+				bmin[c] = std::min(bmin[c], p);
+				bmax[c] = std::max(bmax[c], p);
+			}
+			empty = false;
+		}
+	}
+	return !empty;
+}
+
+// UTF-8 text as quoted JSON string, with quotes, backslashes and control characters escaped
+std::string toJSONString(std::string_view text) {
+	std::string json = "\"";
+	for (const char c: text) {
+		if (c == '"' || c == '\\')
+			json.append({ '\\', c });
+		else if (static_cast<unsigned char>(c) < 0x20) {
+			char escaped[7];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+			json += escaped;
+		}
+		else
+			json += c;
+	}
+	return json + '"';
+}
+
+std::string toJSONString(const std::wstring& text) {
+	return toJSONString(stlenc::toUTF8(text));
+}
+
+// material name usable as ASCII STL solid name, i.e. a single token without whitespace, quotes and backslashes
+std::string toSolidName(const prtx::Material* material) {
+	std::wstring name = (material != nullptr && !material->name().empty()) ? material->name() : DEFAULT_MATERIAL;
+	std::replace_if(name.begin(), name.end(), [](wchar_t c) {
+		return c <= 32 || c == L'"' || c == L'\\';
+	}, L'_');
+	return stlenc::toUTF8(name);
+}
+
+/**
+ * Key of the geometry of a mesh for deduplication: the vertex coordinates relative to the first vertex, snapped to
+ * DEDUP_TOLERANCE, and the vertex indices of the faces. Translated copies merged into world coordinates differ by
+ * the rounding errors of the translation, the snapping makes their keys equal (except for coordinates which happen
+ * to lie on a boundary of the grid). The normals are not part of the key, as the facet normals are recomputed.
+ */
+STLEncoder::MeshKey makeMeshKey(const prtx::Mesh& m) {
+	STLEncoder::MeshKey key;
+	const prtx::DoubleVector& vc = m.getVertexCoords();
+	key.localCoords.resize(vc.size());
+	for (size_t i = 0; i < vc.size(); i++)
+		key.localCoords[i] = std::llround((vc[i] - vc[i % 3]) / DEDUP_TOLERANCE);
+	for (uint32_t fi = 0; fi < m.getFaceCount(); fi++) {
+		const uint32_t* fvi = m.getFaceVertexIndices(fi);
+		key.vertexIndices.insert(key.vertexIndices.end(), fvi, fvi + m.getFaceVertexCount(fi));
+	}
+	return key;
+}
+
+uint64_t hashMeshKey(const STLEncoder::MeshKey& key) {
+	const uint64_t hash = stlenc::hashBytes(key.localCoords.data(), key.localCoords.size() * sizeof(int64_t));
+	return stlenc::hashBytes(key.vertexIndices.data(), key.vertexIndices.size() * sizeof(uint32_t), hash);
+}
+
+std::vector<double> parseRatios(const std::wstring& list) {
+	std::vector<double> ratios;
+	std::wistringstream in(list);
+	for (std::wstring item; std::getline(in, item, L';');) {
+		if (item.find_first_not_of(L" ") == std::wstring::npos)
+			continue;
+		wchar_t* end = nullptr;
+		const double ratio = std::wcstod(item.c_str(), &end);
+		if (end != item.c_str() && ratio > 0.0 && ratio < 1.0)
+			ratios.push_back(ratio);
+		else
+			prt::log((L"STL Encoder: ignoring invalid LOD ratio '" + item + L"'").c_str(), prt::LOG_WARNING);
+	}
+	return ratios;
+}
+
+uint32_t clampFacetCount(uint64_t facetCount) {
+	if (facetCount > std::numeric_limits<uint32_t>::max()) {
+		prt::log(L"STL Encoder: too many facets for binary STL, the facet count in the header is truncated", prt::LOG_ERROR);
+		return std::numeric_limits<uint32_t>::max();
+	}
+	return static_cast<uint32_t>(facetCount);
+}
+
+/**
+ * Removal of degenerate facets and recomputation of bad normals after gathering, see the minFacetArea option.
+ * The counts are collected per block, as the facet ranges of the output depend on them.
+ */
+struct FacetCleanup {
+	explicit FacetCleanup(double minArea, size_t blockCount) : minArea(minArea), removedFacets(blockCount, 0) { }
+
+	void apply(size_t blockIndex, stlenc::FacetTile& tile) {
+		removedFacets[blockIndex] = static_cast<uint32_t>(stlenc::removeDegenerateFacets(tile, minArea));
+		fixedNormals += stlenc::fixFacetNormals(tile, NORMAL_TOLERANCE);
+	}
+
+	const double          minArea;
+	std::vector<uint32_t> removedFacets;
+	std::atomic<uint64_t> fixedNormals{ 0 };
+};
+
+/**
+ * Gathers and formats the facet blocks in parallel and appends them to the output in order.
+ * If the output cache is enabled, the ASCII text of each block is looked up by a hash of its gathered
+ * (i.e. transformed and cleaned up) facets and the precision, and only blocks which are not in the cache
+ * are formatted. Binary facets are not cached: the key of a block is nearly twice the size of its binary output,
+ * which is cheaper to format again than to look up.
+ */
+void formatFacetBlocks(const std::vector<FacetBlock>& blocks, bool binary, int32_t precision, bool computeNormals,
+                       stlenc::WorkerPool& workers, stlenc::ChunkedOutput& output, FacetCleanup* cleanup) {
+	auto gather = [&](const FacetBlock& block, stlenc::FacetScratch& scratch) {
+		stlenc::gatherFacets(block, computeNormals, scratch);
+		if (cleanup != nullptr)
+			cleanup->apply(&block - blocks.data(), scratch.tile);
+	};
+
+	auto formatFacets = [binary, precision](std::vector<uint8_t>& buffer, stlenc::FacetScratch& scratch) {
+		if (binary)
+			stlenc::appendBinaryFacets(buffer, scratch.tile, scratch.floats);
+		else
+			stlenc::appendASCIIFacets(buffer, scratch.tile, precision);
+	};
+
+	stlenc::OutputCache& cache = stlenc::OutputCache::instance();
+	if (binary || !cache.isEnabled()) {
+		auto formatBlock = [&](const FacetBlock& block, std::vector<uint8_t>& buffer, stlenc::FacetScratch& scratch) {
+			gather(block, scratch);
+			formatFacets(buffer, scratch);
+		};
+		stlenc::formatBlocks(blocks, workers, output, formatBlock);
+	}
+	else {
+		const int32_t settings[] = { precision };
+		const uint64_t hits = cache.getHits();
+		const uint64_t misses = cache.getMisses();
+
+		auto formatBlockCached = [&](const FacetBlock& block, std::vector<uint8_t>& buffer,
+		                             stlenc::FacetScratch& scratch) {
+			gather(block, scratch);
+			const size_t componentSize = scratch.tile.size() * sizeof(double);
+			stlenc::OutputCache::Key key(sizeof(settings) + stlenc::FACET_VALUES * componentSize);
+			std::memcpy(key.data(), settings, sizeof(settings));
+			for (size_t c = 0; c < stlenc::FACET_VALUES; c++)
+				std::memcpy(key.data() + sizeof(settings) + c * componentSize, scratch.tile.component(c), componentSize);
+			const uint64_t hash = stlenc::hashBytes(key.data(), key.size());
+			if (const stlenc::OutputCache::Bytes bytes = cache.get(hash, key)) {
+				buffer.insert(buffer.end(), bytes->begin(), bytes->end());
+				return;
+			}
+			const size_t begin = buffer.size();
+			formatFacets(buffer, scratch);
+			cache.put(hash, std::move(key),
+			          std::make_shared<const std::vector<uint8_t>>(buffer.begin() + begin, buffer.end()));
+		};
+		stlenc::formatBlocks(blocks, workers, output, formatBlockCached);
+
+		std::wostringstream msg;
+		msg << L"STL Encoder: output cache hits: " << (cache.getHits() - hits) << L", misses: "
+		    << (cache.getMisses() - misses);
+		prt::log(msg.str().c_str(), prt::LOG_DEBUG);
+	}
+}
+
 } // namespace
 
 
@@ -66,26 +427,223 @@ const std::wstring STLEncoder::DESCRIPTION = L"Example encoder for the STL forma
  * The namespaces are used to create unique names for all mesh and material objects.
  */
 void STLEncoder::init(prtx::GenerateContext& /*context*/) {
-	prtx::NamePreparator::NamespacePtr nsMaterials = mNamePreparator.newNamespace();
-	prtx::NamePreparator::NamespacePtr nsMeshes = mNamePreparator.newNamespace();
-	mEncodePreparator = prtx::EncodePreparator::create(true, mNamePreparator, nsMeshes, nsMaterials);
+	mNamespaceMaterials = mNamePreparator.newNamespace();
+	mNamespaceMeshes = mNamePreparator.newNamespace();
+	mEncodePreparator = prtx::EncodePreparator::create(true, mNamePreparator, mNamespaceMeshes, mNamespaceMaterials);
+
+	const std::wstring format = getOptions()->getString(EO_FORMAT);
+	if (format == FORMAT_BINARY)
+		mFormat = Format::BINARY;
+	else {
+		if (format != FORMAT_ASCII)
+			prt::log((L"STL Encoder: unknown format '" + format + L"', falling back to ascii").c_str(), prt::LOG_WARNING);
+		mFormat = Format::ASCII;
+	}
+
+	const int32_t precision = getOptions()->getInt(EO_PRECISION);
+	mPrecision = std::clamp<int32_t>(precision, stlenc::PRECISION_SHORTEST, stlenc::MAX_PRECISION);
+	if (mPrecision != precision)
+		prt::log((L"STL Encoder: precision clamped to " + std::to_wstring(mPrecision)).c_str(), prt::LOG_WARNING);
+
+	const int32_t threads = getOptions()->getInt(EO_THREADS);
+	const unsigned threadCount =
+			(threads > 0) ? static_cast<unsigned>(threads) : std::max(1u, std::thread::hardware_concurrency());
+	if (!mWorkers || mWorkers->getThreadCount() != threadCount)
+		mWorkers = std::make_unique<stlenc::WorkerPool>(threadCount);
+
+	mIncremental = getOptions()->getBool(EO_INCREMENTAL);
+	mFilePerShape = getOptions()->getBool(EO_FILE_PER_SHAPE);
+
+	const std::wstring preparation = getOptions()->getString(EO_PREPARATION);
+	mFastPreparation = (preparation == PREPARATION_FAST);
+	if (!mFastPreparation && preparation != PREPARATION_FULL)
+		prt::log((L"STL Encoder: unknown preparation '" + preparation + L"', falling back to full").c_str(), prt::LOG_WARNING);
+	mInstancing = getOptions()->getBool(EO_INSTANCING);
+	mEmitStats = getOptions()->getBool(EO_EMIT_STATS);
+	mBatchShapes = static_cast<uint32_t>(std::max(getOptions()->getInt(EO_BATCH_SHAPES), 0));
+	mBatchMemory = uint64_t(std::max(getOptions()->getInt(EO_BATCH_MEMORY), 0)) << 20;
+	mAsyncWrites = getOptions()->getBool(EO_ASYNC_WRITES);
+	mLODRatios = parseRatios(getOptions()->getString(EO_LOD_RATIOS));
+
+	mTileSize = getOptions()->getFloat(EO_TILE_SIZE);
+	if (!(mTileSize >= 0.0)) {
+		prt::log(L"STL Encoder: invalid tile size, writing a single file", prt::LOG_WARNING);
+		mTileSize = 0.0;
+	}
+	if (mTileSize > 0.0 && mFilePerShape)
+		prt::log(L"STL Encoder: tiling is not applied with one file per initial shape", prt::LOG_WARNING);
+
+	mRecenter = getOptions()->getBool(EO_RECENTER);
+
+	std::wstring warnings;
+	mCompression = stlenc::parseCompression(getOptions()->getString(EO_COMPRESSION), warnings);
+	if (!warnings.empty())
+		prt::log((L"STL Encoder: " + warnings).c_str(), prt::LOG_WARNING);
+	warnings.clear();
+	mCompressionLevel = stlenc::clampCompressionLevel(mCompression, getOptions()->getInt(EO_COMPRESSION_LVL), warnings);
+	if (!warnings.empty())
+		prt::log((L"STL Encoder: " + warnings).c_str(), prt::LOG_WARNING);
+
+	mDirectOutputPath = getOptions()->getString(EO_DIRECT_OUTPUT);
+	if (!mDirectOutputPath.empty() && (mFormat != Format::BINARY || mCompression != stlenc::Compression::NONE)) {
+		prt::log(L"STL Encoder: direct output requires uncompressed binary STL, writing via callbacks", prt::LOG_WARNING);
+		mDirectOutputPath.clear();
+	}
+	if (!mDirectOutputPath.empty() && (!mLODRatios.empty() || mRecenter || mEmitStats)) {
+		// the levels of detail and the JSON files are written via callbacks, keep all files of an export together
+		prt::log(L"STL Encoder: direct output is not applied with levels of detail, recentering or statistics, "
+		         L"writing via callbacks", prt::LOG_WARNING);
+		mDirectOutputPath.clear();
+	}
+
+	mDeduplicate = getOptions()->getBool(EO_DEDUPLICATE);
+	if (mDeduplicate && (mFilePerShape || mTileSize > 0.0)) {
+		prt::log(L"STL Encoder: deduplication is only applied to a single output file", prt::LOG_WARNING);
+		mDeduplicate = false;
+	}
+	if (mDeduplicate && (mBatchShapes > 0 || mBatchMemory > 0)) {
+		// all written meshes are kept to find their copies, so the memory would not be bounded by the batches
+		prt::log(L"STL Encoder: deduplication keeps all meshes until the end, it is not applied with batched writing",
+		         prt::LOG_WARNING);
+		mDeduplicate = false;
+	}
+
+	mMinFacetArea = std::max(getOptions()->getFloat(EO_MIN_FACET_AREA), 0.0);
+
+	// the facet count in the header of binary STL is patched after writing, which is not possible in a compressed stream
+	const bool batched = !mFilePerShape && (mIncremental || mBatchShapes > 0 || mBatchMemory > 0);
+	if (mFormat == Format::BINARY && mCompression != stlenc::Compression::NONE
+	    && (batched || mDeduplicate || mMinFacetArea > 0.0)) {
+		prt::log(L"STL Encoder: the facet count of binary STL is not known up front with incremental or batched writing, "
+		         L"deduplication or facet removal, writing uncompressed output", prt::LOG_WARNING);
+		mCompression = stlenc::Compression::NONE;
+	}
+
+	mSolidPerMaterial = getOptions()->getBool(EO_SOLID_PER_MATERIAL);
+	if (mSolidPerMaterial && (mFilePerShape || mIncremental || mBatchShapes > 0 || mBatchMemory > 0 || mTileSize > 0.0
+	                          || mDeduplicate)) {
+		prt::log(L"STL Encoder: solids per material require a single file written at once, writing one solid",
+		         prt::LOG_WARNING);
+		mSolidPerMaterial = false;
+	}
+
+	// the cache is shared by all exports of the process, leave it alone unless the size is given
+	const int32_t cacheSize = getOptions()->getInt(EO_CACHE_SIZE);
+	if (cacheSize >= 0)
+		stlenc::OutputCache::instance().setCapacity(size_t(cacheSize) << 20);
 }
 
 
 /**
  * During encoding we collect the resulting shapes with the encode preparator.
  * In case the shape generation fails, we collect the initial shape.
+ * In incremental mode, the shapes are finalized and written right away.
+ * In batched mode, they are finalized and written as soon as the batch is full (by initial shape count or by the
+ * estimated geometry size), so the memory held by the encode preparator is bounded by the batch size.
+ * With one file per initial shape, the file of the initial shape is written and closed right away.
+ * Levels of detail are written along with the full resolution geometry, wherever it is written.
+ * With tiling, the tile files stay open until finish() and receive the instances of each batch which fall into them.
  */
 void STLEncoder::encode(prtx::GenerateContext& context, size_t initialShapeIndex) {
+	const Clock::time_point t0 = Clock::now();
 	const prtx::InitialShape* is = context.getInitialShape(initialShapeIndex);
 	try {
 		const prtx::LeafIteratorPtr li = prtx::LeafIterator::create(context, initialShapeIndex);
 		for (prtx::ShapePtr shape = li->getNext(); shape.get() != nullptr; shape = li->getNext()) {
 			mEncodePreparator->add(context.getCache(), shape, is->getAttributeMap());
+			if (mBatchMemory > 0)
+				mPendingMemory += estimateGeometrySize(*shape);
 		}
 	} catch(...) {
 		mEncodePreparator->add(context.getCache(), *is, initialShapeIndex);
 	}
+	mStats.addTime += millisecondsSince(t0);
+	mPendingShapes++;
+	const bool batchFull = (mBatchShapes > 0 && mPendingShapes >= mBatchShapes)
+	                       || (mBatchMemory > 0 && mPendingMemory >= mBatchMemory);
+
+	if (mFilePerShape) {
+		const std::wstring baseName = getOptions()->getString(EO_BASE_NAME);
+		// names are made unique, without case and including the LOD files, by the initial shape index, which in turn
+		// may be the name of another shape
+		const std::wstring name = toFileName(is->getName());
+		std::wstring shapeName = name;
+		for (size_t i = 0; shapeName.empty() || !reserveShapeFileName(shapeName); i++) {
+			shapeName = name + (name.empty() ? L"" : L"_") + std::to_wstring(initialShapeIndex)
+			            + ((i > 0) ? L"_" + std::to_wstring(i) : L"");
+		}
+
+		std::vector<prtx::EncodePreparator::FinalizedInstance> finalizedInstances = fetchFinalizedInstances();
+		if (mRecenter && !mHasOrigin) // no vertices so far, all files are written once the origin is known
+			mDeferredShapeFiles.emplace_back(shapeName, std::move(finalizedInstances));
+		else {
+			writeDeferredShapeFiles(baseName);
+			writeShapeFile(baseName, shapeName, finalizedInstances);
+		}
+	}
+	else if (mIncremental || batchFull) {
+		const std::wstring baseName = getOptions()->getString(EO_BASE_NAME);
+		const std::vector<prtx::EncodePreparator::FinalizedInstance> finalizedInstances = fetchFinalizedInstances();
+		if (mTileSize > 0.0)
+			writeTiles(finalizedInstances, baseName, false);
+		else if (!mRecenter || mHasOrigin) { // otherwise there is nothing to write yet, see setOrigin()
+			if (!mFile.output)
+				openFile(baseName + STL_EXT, baseName, 0, mFile);
+			if (mDeduplicate)
+				writeUniqueMeshes(finalizedInstances, mFile);
+			else
+				writeFacets(finalizedInstances, mFile);
+			writeLODs(finalizedInstances, baseName, baseName, mLODFiles);
+		}
+		mPendingShapes = 0;
+		mPendingMemory = 0;
+	}
+}
+
+
+/**
+ * Reserves the file names of a shape, i.e. its STL file and the LOD files next to it, compared without case.
+ * Fails without reserving anything if one of them is taken, e.g. shape "x_lod1" after shape "x" with LODs.
+ */
+bool STLEncoder::reserveShapeFileName(const std::wstring& shapeName) {
+	std::vector<std::wstring> keys = { toFileNameKey(shapeName) };
+	for (size_t l = 0; l < mLODRatios.size(); l++)
+		keys.push_back(keys.front() + LOD_SUFFIX + std::to_wstring(l + 1));
+	if (std::any_of(keys.begin(), keys.end(), [this](const std::wstring& k) { return mShapeFileNames.count(k) > 0; }))
+		return false;
+	mShapeFileNames.insert(keys.begin(), keys.end());
+	return true;
+}
+
+
+/**
+ * Writes the file(s) of one initial shape, see the filePerInitialShape option.
+ */
+void STLEncoder::writeShapeFile(const std::wstring& baseName, const std::wstring& shapeName,
+                                const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances) {
+	OutputFile file;
+	std::vector<OutputFile> lodFiles;
+	const std::wstring fileName = baseName + L"_" + shapeName + STL_EXT;
+	const bool mapped = writeMappedFile(fileName, finalizedInstances);
+	if (!mapped) {
+		openFile(fileName, shapeName, countFacets(finalizedInstances), file);
+		writeFacets(finalizedInstances, file);
+	}
+	writeLODs(finalizedInstances, baseName + L"_" + shapeName, shapeName, lodFiles);
+	if (!mapped)
+		closeFile(file);
+	for (OutputFile& lodFile: lodFiles)
+		closeFile(lodFile);
+}
+
+
+/**
+ * Writes the files of the initial shapes which were held back while the origin was not known, see setOrigin().
+ */
+void STLEncoder::writeDeferredShapeFiles(const std::wstring& baseName) {
+	for (const auto& [shapeName, finalizedInstances]: mDeferredShapeFiles)
+		writeShapeFile(baseName, shapeName, finalizedInstances);
+	mDeferredShapeFiles.clear();
 }
 
 
@@ -94,49 +652,701 @@ void STLEncoder::encode(prtx::GenerateContext& context, size_t initialShapeIndex
  * finalized geometry instances.
  */
 void STLEncoder::finish(prtx::GenerateContext& /*context*/) {
-	prt::SimpleOutputCallbacks* soh = dynamic_cast<prt::SimpleOutputCallbacks*>(getCallbacks());
-	const std::wstring baseName = getOptions()->getString(EO_BASE_NAME);
+	if (mFilePerShape) // all other files have been written in encode()
+		writeDeferredShapeFiles(getOptions()->getString(EO_BASE_NAME));
+	else {
+		const std::wstring baseName = getOptions()->getString(EO_BASE_NAME);
+		const std::vector<prtx::EncodePreparator::FinalizedInstance> finalizedInstances = fetchFinalizedInstances();
+
+		if (mTileSize > 0.0) {
+			writeTiles(finalizedInstances, baseName, true);
+			closeTiles(baseName);
+		}
+		else {
+			// the size of the file is only known if nothing has been written yet
+			const bool mapped = !mFile.output && !mDeduplicate && !mSolidPerMaterial
+			                    && writeMappedFile(baseName + STL_EXT, finalizedInstances);
+			if (!mapped) {
+				if (!mFile.output) {
+					mFile.materialSolids = mSolidPerMaterial;
+					openFile(baseName + STL_EXT, baseName, mDeduplicate ? 0 : countFacets(finalizedInstances), mFile);
+				}
+				if (mDeduplicate)
+					writeUniqueMeshes(finalizedInstances, mFile);
+				else if (mSolidPerMaterial)
+					writeMaterialSolids(finalizedInstances, mFile, baseName);
+				else
+					writeFacets(finalizedInstances, mFile);
+			}
+			writeLODs(finalizedInstances, baseName, baseName, mLODFiles);
+			if (!mapped)
+				closeFile(mFile);
+			for (OutputFile& lodFile: mLODFiles)
+				closeFile(lodFile);
+			if (mDeduplicate)
+				writeInstanceTable(baseName);
+		}
+	}
+
+	if (mHasOrigin)
+		writeOrigin(getOptions()->getString(EO_BASE_NAME));
+
+	if (mMinFacetArea > 0.0) {
+		std::wostringstream msg;
+		msg << L"STL Encoder: removed " << mStats.removedFacets << L" degenerate facets, recomputed "
+		    << mStats.fixedNormals << L" normals";
+		prt::log(msg.str().c_str(), prt::LOG_INFO);
+	}
+
+	if (mEmitStats)
+		emitStats();
+}
+
+
+/**
+ * Finalizes all shapes collected so far and resets the encode preparator, so their geometry
+ * is released as soon as the returned instances have been written.
+ */
+std::vector<prtx::EncodePreparator::FinalizedInstance> STLEncoder::fetchFinalizedInstances() {
+	const Clock::time_point t0 = Clock::now();
+	prtx::EncodePreparator::PreparationFlags flags = mFastPreparation ? ENC_PREP_FLAGS_FAST : ENC_PREP_FLAGS;
+	flags.instancing(mInstancing);
+	if (mDeduplicate) // merged meshes of a whole batch would rarely be identical, keep the meshes of each shape apart
+		flags.meshMerging(prtx::MeshMerging::NONE);
 
 	std::vector<prtx::EncodePreparator::FinalizedInstance> finalizedInstances;
-	mEncodePreparator->fetchFinalizedInstances(finalizedInstances, ENC_PREP_FLAGS);
+	mEncodePreparator->fetchFinalizedInstances(finalizedInstances, flags);
+	const double dt = millisecondsSince(t0);
+	mStats.fetchTime += dt;
+
+	std::wostringstream msg;
+	msg << L"STL Encoder: fetchFinalizedInstances (" << (mFastPreparation ? PREPARATION_FAST : PREPARATION_FULL)
+	    << L" preparation" << (mInstancing ? L", instancing" : L"") << L") took " << dt << L" ms for "
+	    << finalizedInstances.size() << L" instances";
+	prt::log(msg.str().c_str(), prt::LOG_DEBUG);
+
+	mEncodePreparator = prtx::EncodePreparator::create(true, mNamePreparator, mNamespaceMeshes, mNamespaceMaterials);
+	if (mRecenter && !mHasOrigin)
+		setOrigin(finalizedInstances);
+	return finalizedInstances;
+}
+
+
+/**
+ * Sets the local origin of the output to the center of the bounding box of the first fetched instances with
+ * vertices, i.e. of the whole scene unless writing incrementally, in batches or per initial shape. It is rounded to
+ * whole units, so it is short to record and all files use the exact same offset. Until it is set, no file is opened,
+ * so every header gets the origin.
+ */
+void STLEncoder::setOrigin(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances) {
+	double sceneMin[3], sceneMax[3];
+	std::fill_n(sceneMin, 3, std::numeric_limits<double>::max());
+	std::fill_n(sceneMax, 3, std::numeric_limits<double>::lowest());
+	for (const auto& instance: finalizedInstances) {
+		double bmin[3], bmax[3];
+		if (!computeBounds(instance, bmin, bmax))
+			continue;
+		for (int c = 0; c < 3; c++) {
+			sceneMin[c] = std::min(sceneMin[c], bmin[c]);
+			sceneMax[c] = std::max(sceneMax[c], bmax[c]);
+		}
+		mHasOrigin = true;
+	}
+
+	if (mHasOrigin) {
+		for (int c = 0; c < 3; c++)
+			mOrigin[c] = std::round(0.5 * (sceneMin[c] + sceneMax[c]));
+
+		std::wostringstream msg;
+		msg << std::fixed << std::setprecision(0) << L"STL Encoder: writing coordinates relative to the origin ("
+		    << mOrigin[0] << L", " << mOrigin[1] << L", " << mOrigin[2] << L")";
+		prt::log(msg.str().c_str(), prt::LOG_INFO);
+	}
+}
+
+
+/**
+ * Writes the local origin to <baseName>_origin.json, to be added to the coordinates of the STL file(s).
+ */
+void STLEncoder::writeOrigin(const std::wstring& baseName) const {
+	std::ostringstream json;
+	json << std::fixed << std::setprecision(0)
+	     << "{\n"
+	     << "  \"origin\": [" << mOrigin[0] << ", " << mOrigin[1] << ", " << mOrigin[2] << "]\n"
+	     << "}\n";
+
+	writeSidecar(baseName + ORIGIN_SUFFIX, json.str());
+}
+
+
+/**
+ * Opens the output file via callback and writes the STL header. For binary STL, the facet count of the
+ * header is patched in closeFile() if it differs from expectedFacetCount (e.g. in incremental mode).
+ */
+void STLEncoder::openFile(const std::wstring& fileName, const std::wstring& solidName, uint64_t expectedFacetCount,
+                          OutputFile& file) const {
+	prt::SimpleOutputCallbacks* soh = dynamic_cast<prt::SimpleOutputCallbacks*>(getCallbacks());
+
+	// let the client application write the file via callback, as (compressed) bytes in chunks of bounded size,
+	// optionally from a writer thread
+	// the compressor is created first, so a failure does not leave an open file behind
+	std::unique_ptr<stlenc::Compressor> compressor = stlenc::Compressor::create(mCompression, mCompressionLevel);
+	const std::wstring fullFileName = fileName + stlenc::Compressor::getFileExtension(mCompression);
+	file.handle = soh->open(ID.c_str(), prt::CT_GEOMETRY, fullFileName.c_str());
+	file.output = std::make_unique<stlenc::ChunkedOutput>(soh, file.handle, std::move(compressor),
+	                                                      mAsyncWrites ? WRITER_BUFFERS : 0);
+	file.facetCount = 0;
+
+	if (mFormat == Format::BINARY) {
+		file.headerFacetCount = clampFacetCount(expectedFacetCount);
+		stlenc::appendBinaryHeader(file.output->getBuffer(), getBinaryHeader(), file.headerFacetCount);
+	}
+	else if (!file.materialSolids)
+		file.output->append("solid " + stlenc::toUTF8(solidName) + "\n");
+}
+
+
+std::string STLEncoder::getBinaryHeader() const {
+	if (!mHasOrigin)
+		return BINARY_HEADER;
 
-	std::wostringstream out;
-	out << std::scientific;
-	out << L"solid " << baseName << L"\n";
+	// fits into the 80 bytes, the origin is rounded to whole units
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(0) << BINARY_HEADER_RECENTERED
+	     << mOrigin[0] << ' ' << mOrigin[1] << ' ' << mOrigin[2];
+	return text.str();
+}
+
+
+/**
+ * Fast path for binary STL on local disk (see the directOutputPath option): as the size of the file is known
+ * up front, it is created at its final size and mapped into memory, and the facet blocks are formatted in parallel
+ * directly to their place in the file, without passing through the output callbacks.
+ * Returns false if the fast path is disabled or the file cannot be mapped, the caller then writes via callbacks.
+ */
+bool STLEncoder::writeMappedFile(const std::wstring& fileName,
+                                 const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances) {
+	if (mDirectOutputPath.empty() || mMinFacetArea > 0.0) // the cleanup changes the size of the file
+		return false;
+
+	const Clock::time_point t0 = Clock::now();
+	std::deque<std::array<double, 16>> transforms;
+	const std::vector<FacetBlock> blocks = collectFacetBlocks(finalizedInstances, nullptr,
+	                                                          mHasOrigin ? mOrigin : nullptr, transforms);
+	std::vector<uint64_t> firstFacets(blocks.size());
+	uint64_t facetCount = 0;
+	for (size_t bi = 0; bi < blocks.size(); bi++) {
+		firstFacets[bi] = facetCount;
+		facetCount += blocks[bi].faceEnd - blocks[bi].faceBegin;
+	}
+	if (facetCount != clampFacetCount(facetCount))
+		return false; // let closeFile() report the overflow of the facet count
+
+	const uint64_t headerSize = stlenc::BINARY_HEADER_SIZE + sizeof(uint32_t);
+	const uint64_t fileSize = headerSize + facetCount * stlenc::BINARY_FACET_SIZE;
+	std::unique_ptr<stlenc::MappedFile> file;
+	try {
+		file = std::make_unique<stlenc::MappedFile>(std::filesystem::path(mDirectOutputPath) / fileName, fileSize);
+	}
+	catch (const std::exception& e) {
+		const std::string reason = e.what();
+		prt::log((L"STL Encoder: direct output failed, writing via callbacks: "
+		          + std::wstring(reason.begin(), reason.end())).c_str(), prt::LOG_WARNING);
+		return false;
+	}
+
+	uint8_t* const data = file->data();
+	stlenc::writeBinaryHeader(data, getBinaryHeader(), static_cast<uint32_t>(facetCount));
+	const bool computeNormals = mFastPreparation;
+	stlenc::formatBlocksInPlace(blocks.size(), *mWorkers, [&](size_t bi, stlenc::FacetScratch& scratch) {
+		stlenc::gatherFacets(blocks[bi], computeNormals, scratch);
+		stlenc::writeBinaryFacets(data + headerSize + firstFacets[bi] * stlenc::BINARY_FACET_SIZE, scratch.tile,
+		                          scratch.floats);
+	});
+	file.reset();
+
+	mStats.instanceCount += finalizedInstances.size();
+	for (const auto& instance: finalizedInstances)
+		mStats.meshCount += instance.getGeometry()->getMeshes().size();
+	mStats.facetCount += facetCount;
+	mStats.bytesWritten += fileSize;
+	mStats.formatTime += millisecondsSince(t0); // includes writing, which happens on page faults and unmapping
+	return true;
+}
+
+
+/**
+ * ASCII STL: one "facet normal ... endfacet" block per facet, formatted with std::to_chars,
+ * either with a fixed number of significant digits or shortest round-trip.
+ * Binary STL: one packed 50 byte float32 record per facet, converted from double in blocks.
+ */
+void STLEncoder::writeFacets(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+                             OutputFile& file, const MeshSubstitutes* substitutes) {
+	const Clock::time_point t0 = Clock::now();
+	const double blockingTime0 = file.output->getBlockingTime();
+
+	std::deque<std::array<double, 16>> transforms;
+	const std::vector<FacetBlock> blocks = collectFacetBlocks(finalizedInstances, substitutes,
+	                                                          mHasOrigin ? mOrigin : nullptr, transforms);
+	for (const FacetBlock& block: blocks)
+		file.facetCount += block.faceEnd - block.faceBegin;
+
+	if (substitutes == nullptr) { // levels of detail repeat the same instances
+		mStats.instanceCount += finalizedInstances.size();
+		for (const auto& instance: finalizedInstances)
+			mStats.meshCount += instance.getGeometry()->getMeshes().size();
+	}
+
+	writeFacetBlocks(blocks, file);
+
+	// writing and compression are accounted for in closeFile()
+	mStats.formatTime += millisecondsSince(t0) - (file.output->getBlockingTime() - blockingTime0);
+}
+
+
+/**
+ * Gathers and formats the blocks to the file, see formatFacetBlocks(), and removes degenerate facets and recomputes
+ * bad normals if the minFacetArea option is set. Returns the number of removed facets per block, they are already
+ * subtracted from the facet count of the file.
+ */
+std::vector<uint32_t> STLEncoder::writeFacetBlocks(const std::vector<FacetBlock>& blocks, OutputFile& file) {
+	FacetCleanup cleanup(mMinFacetArea, blocks.size());
+	formatFacetBlocks(blocks, mFormat == Format::BINARY, mPrecision, mFastPreparation, *mWorkers, *file.output,
+	                  (mMinFacetArea > 0.0) ? &cleanup : nullptr);
+
+	const uint64_t removedFacets = std::accumulate(cleanup.removedFacets.begin(), cleanup.removedFacets.end(),
+	                                               uint64_t(0));
+	file.facetCount -= removedFacets;
+	mStats.removedFacets += removedFacets;
+	mStats.fixedNormals += cleanup.fixedNormals;
+	return std::move(cleanup.removedFacets);
+}
+
+
+/**
+ * Writes the facets grouped by material, in order of the first occurrence of each material. ASCII STL gets one
+ * "solid <material>" block per material. The byte range (of the uncompressed file) and the facet range of each
+ * group are written to <baseName>_materials.json, so a reader can seek directly to a material.
+ */
+void STLEncoder::writeMaterialSolids(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+                                     OutputFile& file, const std::wstring& baseName) {
+	const Clock::time_point t0 = Clock::now();
+	const double blockingTime0 = file.output->getBlockingTime();
+
+	std::deque<std::array<double, 16>> transforms;
+	const std::vector<FacetBlock> blocks = collectFacetBlocks(finalizedInstances, nullptr,
+	                                                          mHasOrigin ? mOrigin : nullptr, transforms);
+	std::vector<std::string> groupNames;
+	std::vector<std::vector<FacetBlock>> groups;
+	std::unordered_map<std::string, size_t> groupIndices;
+	for (const FacetBlock& block: blocks) {
+		const std::string name = toSolidName(block.material);
+		const auto [gi, inserted] = groupIndices.try_emplace(name, groups.size());
+		if (inserted) {
+			groupNames.push_back(name);
+			groups.emplace_back();
+		}
+		groups[gi->second].push_back(block);
+	}
+
+	mStats.instanceCount += finalizedInstances.size();
+	for (const auto& instance: finalizedInstances)
+		mStats.meshCount += instance.getGeometry()->getMeshes().size();
+
+	const bool ascii = (mFormat == Format::ASCII);
+	std::ostringstream json;
+	json << "{\n"
+	     << "  \"file\": " << toJSONString(baseName + STL_EXT + stlenc::Compressor::getFileExtension(mCompression))
+	     << ",\n"
+	     << "  \"materials\": [";
+	for (size_t g = 0; g < groups.size(); g++) {
+		const uint64_t byteOffset = file.output->getPosition();
+		const uint64_t firstFacet = file.facetCount;
+		if (ascii)
+			file.output->append("solid " + groupNames[g] + "\n");
+		for (const FacetBlock& block: groups[g])
+			file.facetCount += block.faceEnd - block.faceBegin;
+		writeFacetBlocks(groups[g], file);
+		if (ascii)
+			file.output->append("endsolid " + groupNames[g] + "\n");
+
+		json << (g == 0 ? "\n" : ",\n") << "    { \"name\": " << toJSONString(groupNames[g]) << ", "
+		     << "\"byteOffset\": " << byteOffset << ", \"byteSize\": " << file.output->getPosition() - byteOffset << ", "
+		     << "\"firstFacet\": " << firstFacet << ", \"facets\": " << file.facetCount - firstFacet << " }";
+	}
+	json << "\n  ]\n}\n";
+	if (ascii && groups.empty()) { // an ASCII STL file holds at least one solid
+		const std::string solidName = stlenc::toUTF8(baseName);
+		file.output->append("solid " + solidName + "\nendsolid " + solidName + "\n");
+	}
+
+	mStats.formatTime += millisecondsSince(t0) - (file.output->getBlockingTime() - blockingTime0);
+
+	writeSidecar(baseName + MATERIALS_SUFFIX, json.str());
+}
+
+
+/**
+ * Writes each distinct mesh only once, relative to its first vertex, and records every occurrence of it with the
+ * transformation back to world coordinates for writeInstanceTable(). Meshes are identified by their local geometry
+ * (see makeMeshKey()), so translated copies of the same mesh are found also without instancing. An occurrence is
+ * thus placed with the geometry of the first copy, which deviates by less than DEDUP_TOLERANCE.
+ */
+void STLEncoder::writeUniqueMeshes(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+                                   OutputFile& file) {
+	const Clock::time_point t0 = Clock::now();
+	const double blockingTime0 = file.output->getBlockingTime();
+
+	std::vector<FacetBlock> blocks;
+	std::vector<std::pair<uint32_t, size_t>> newMeshes; // id and first block of the meshes written by this call
+	std::deque<std::array<double, 16>> translations; // stable addresses for the blocks
+	for (const auto& instance: finalizedInstances) {
+		const prtx::DoubleVector& trafo = instance.getTransformation();
+		const double* m = (trafo.size() == 16) ? trafo.data() : IDENTITY;
+		for (const prtx::MeshPtr& mesh: instance.getGeometry()->getMeshes()) {
+			const prtx::DoubleVector& vc = mesh->getVertexCoords();
+			if (vc.size() < 3 || mesh->getFaceCount() == 0)
+				continue;
+
+			const double origin[3] = { vc[0], vc[1], vc[2] };
+			MeshKey key = makeMeshKey(*mesh);
+			const uint64_t hash = hashMeshKey(key);
+			const auto candidates = mUniqueMeshIds.equal_range(hash);
+			const auto match = std::find_if(candidates.first, candidates.second, [&](const auto& candidate) {
+				return mUniqueMeshes[candidate.second].key == key; // rules out hash collisions
+			});
+			const uint32_t id = (match != candidates.second) ? match->second : static_cast<uint32_t>(mUniqueMeshes.size());
+			if (match == candidates.second) {
+				const uint32_t n = mesh->getFaceCount();
+				mUniqueMeshIds.emplace(hash, id);
+				newMeshes.emplace_back(id, blocks.size());
+				mUniqueMeshes.push_back({ file.facetCount, n, std::move(key) });
+				file.facetCount += n;
+
+				std::array<double, 16>& translation = translations.emplace_back();
+				std::copy_n(IDENTITY, 16, translation.begin());
+				for (int c = 0; c < 3; c++)
+					translation[12 + c] = -origin[c];
+				for (uint32_t fb = 0; fb < n; fb += stlenc::FACET_BLOCK_SIZE)
+					blocks.push_back({ mesh.get(), fb, std::min(n, fb + stlenc::FACET_BLOCK_SIZE), translation.data() });
+			}
+
+			// the instance transformation after the translation from the local origin
+			MeshOccurrence& occurrence = mMeshOccurrences.emplace_back();
+			occurrence.meshId = id;
+			occurrence.initialShapeIndex = instance.getInitialShapeIndex();
+			std::copy_n(m, 16, occurrence.transform);
+			for (int c = 0; c < 3; c++) {
+				occurrence.transform[12 + c] = m[c] * origin[0] + m[4 + c] * origin[1] + m[8 + c] * origin[2] + m[12 + c]
+				                               - mOrigin[c];
+			}
+		}
+	}
+
+	mStats.instanceCount += finalizedInstances.size();
+	for (const auto& instance: finalizedInstances)
+		mStats.meshCount += instance.getGeometry()->getMeshes().size();
+
+	const std::vector<uint32_t> removedFacets = writeFacetBlocks(blocks, file);
+	if (!newMeshes.empty()) { // move the facet ranges by the removed facets
+		uint64_t firstFacet = mUniqueMeshes[newMeshes.front().first].firstFacet;
+		for (size_t i = 0; i < newMeshes.size(); i++) {
+			const size_t blockEnd = (i + 1 < newMeshes.size()) ? newMeshes[i + 1].second : blocks.size();
+			UniqueMesh& mesh = mUniqueMeshes[newMeshes[i].first];
+			mesh.firstFacet = firstFacet;
+			mesh.facetCount -= std::accumulate(removedFacets.begin() + newMeshes[i].second,
+			                                   removedFacets.begin() + blockEnd, uint64_t(0));
+			firstFacet += mesh.facetCount;
+		}
+	}
+	mStats.formatTime += millisecondsSince(t0) - (file.output->getBlockingTime() - blockingTime0);
+}
+
+
+/**
+ * Writes <baseName>_instances.json with the facet range of each unique mesh in the STL file and the mesh and
+ * transformation of each of its occurrences.
+ */
+void STLEncoder::writeInstanceTable(const std::wstring& baseName) const {
+	std::ostringstream json;
+	json << std::setprecision(std::numeric_limits<double>::max_digits10);
+	json << "{\n"
+	     << "  \"file\": " << toJSONString(baseName + STL_EXT + stlenc::Compressor::getFileExtension(mCompression))
+	     << ",\n"
+	     << "  \"meshes\": [";
+	for (size_t i = 0; i < mUniqueMeshes.size(); i++) {
+		json << (i == 0 ? "\n" : ",\n") << "    { \"firstFacet\": " << mUniqueMeshes[i].firstFacet
+		     << ", \"facets\": " << mUniqueMeshes[i].facetCount << " }";
+	}
+	json << "\n  ],\n"
+	     << "  \"instances\": [";
+	for (size_t i = 0; i < mMeshOccurrences.size(); i++) {
+		const MeshOccurrence& occurrence = mMeshOccurrences[i];
+		json << (i == 0 ? "\n" : ",\n") << "    { \"mesh\": " << occurrence.meshId
+		     << ", \"initialShape\": " << occurrence.initialShapeIndex << ", \"transform\": [";
+		for (int j = 0; j < 16; j++)
+			json << (j == 0 ? "" : ", ") << occurrence.transform[j];
+		json << "] }";
+	}
+	json << "\n  ]\n}\n";
+
+	std::wostringstream msg;
+	msg << L"STL Encoder: wrote " << mUniqueMeshes.size() << L" unique meshes for " << mMeshOccurrences.size()
+	    << L" mesh occurrences";
+	prt::log(msg.str().c_str(), prt::LOG_INFO);
+
+	writeSidecar(baseName + INSTANCES_SUFFIX, json.str());
+}
+
+
+/**
+ * Partitions the instances into a grid of square tiles of mTileSize on the ground plane, by the center of their
+ * bounding box, and writes each non-empty tile to <baseName>_tile_<x>_<z>.stl. On the last write, the tile files
+ * are closed right away instead of keeping them open for further batches.
+ * Otherwise, at most MAX_OPEN_TILE_FILES files are kept open, so the memory and the writer threads do not grow with
+ * the number of tiles: the least recently written tile is closed, and if it receives more instances in a later
+ * batch, they are written to a new part <baseName>_tile_<x>_<z>_part<n>.stl.
+ */
+void STLEncoder::writeTiles(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+                            const std::wstring& baseName, bool lastWrite) {
+	std::map<TileKey, std::vector<prtx::EncodePreparator::FinalizedInstance>> tileInstances;
+	for (const auto& instance: finalizedInstances) {
+		double bmin[3], bmax[3];
+		if (!computeBounds(instance, bmin, bmax))
+			continue;
+
+		const TileKey key(static_cast<int64_t>(std::floor(0.5 * (bmin[0] + bmax[0]) / mTileSize)),
+		                  static_cast<int64_t>(std::floor(0.5 * (bmin[2] + bmax[2]) / mTileSize)));
+		const auto [tile, inserted] = mTiles.try_emplace(key);
+		for (int c = 0; c < 3; c++) {
+			tile->second.boundsMin[c] = inserted ? bmin[c] : std::min(tile->second.boundsMin[c], bmin[c]);
+			tile->second.boundsMax[c] = inserted ? bmax[c] : std::max(tile->second.boundsMax[c], bmax[c]);
+		}
+		tileInstances[key].push_back(instance);
+	}
+
+	const size_t maxOpenTiles = std::max<size_t>(1, MAX_OPEN_TILE_FILES / (1 + mLODRatios.size()));
+	for (const auto& [key, instances]: tileInstances) {
+		TileOutput& tile = mTiles.at(key);
+		const bool newPart = !tile.file.output;
+		if (newPart) {
+			while (mOpenTiles.size() >= maxOpenTiles) {
+				closeTile(mTiles.at(mOpenTiles.begin()->second));
+				mOpenTiles.erase(mOpenTiles.begin());
+			}
+		}
+		else
+			mOpenTiles.erase(tile.lastUse);
+
+		const size_t part = newPart ? tile.fileNames.size() : tile.fileNames.size() - 1;
+		std::wstring tileName = baseName + TILE_INFIX + std::to_wstring(key.first) + L"_" + std::to_wstring(key.second);
+		if (part > 0)
+			tileName += TILE_PART_INFIX + std::to_wstring(part);
+		if (newPart) {
+			tile.fileNames.push_back(tileName + STL_EXT + stlenc::Compressor::getFileExtension(mCompression));
+			openFile(tileName + STL_EXT, tileName, countFacets(instances), tile.file);
+		}
+		writeFacets(instances, tile.file);
+		writeLODs(instances, tileName, tileName, tile.lodFiles);
+
+		if (lastWrite)
+			closeTile(tile);
+		else {
+			tile.lastUse = mTileUses++;
+			mOpenTiles.emplace(tile.lastUse, key);
+		}
+	}
+}
 
+
+void STLEncoder::closeTile(TileOutput& tile) {
+	closeFile(tile.file);
+	for (OutputFile& lodFile: tile.lodFiles)
+		closeFile(lodFile);
+	tile.facetCount += tile.file.facetCount;
+}
+
+
+/**
+ * Closes the tile files which are still open and writes the tile index <baseName>_tiles.json with the grid cell,
+ * the bounding box, the file(s) and the facet count of each tile.
+ */
+void STLEncoder::closeTiles(const std::wstring& baseName) {
+	for (const auto& [lastUse, key]: mOpenTiles)
+		closeTile(mTiles.at(key));
+	mOpenTiles.clear();
+
+	std::ostringstream json;
+	json << std::setprecision(std::numeric_limits<double>::max_digits10);
+	json << "{\n"
+	     << "  \"tileSize\": " << mTileSize << ",\n"
+	     << "  \"groundPlane\": \"xz\",\n"
+	     << "  \"tiles\": [";
+	const char* separator = "\n";
+	for (const auto& [key, tile]: mTiles) {
+		json << separator << "    { \"files\": [";
+		for (size_t i = 0; i < tile.fileNames.size(); i++)
+			json << (i == 0 ? "" : ", ") << toJSONString(tile.fileNames[i]);
+		json << "], "
+		     << "\"cell\": [" << key.first << ", " << key.second << "], "
+		     << "\"cellMin\": [" << key.first * mTileSize << ", " << key.second * mTileSize << "], "
+		     << "\"cellMax\": [" << (key.first + 1) * mTileSize << ", " << (key.second + 1) * mTileSize << "], "
+		     << "\"boundsMin\": [" << tile.boundsMin[0] << ", " << tile.boundsMin[1] << ", " << tile.boundsMin[2] << "], "
+		     << "\"boundsMax\": [" << tile.boundsMax[0] << ", " << tile.boundsMax[1] << ", " << tile.boundsMax[2] << "], "
+		     << "\"facets\": " << tile.facetCount << " }";
+		separator = ",\n";
+	}
+	json << "\n  ]\n}\n";
+	mTiles.clear();
+
+	writeSidecar(baseName + TILE_INDEX_SUFFIX, json.str());
+}
+
+
+/**
+ * Writes the decimated geometry of each level of detail to <fileBaseName>_lod<level>.stl, the files are opened
+ * on first use and closed by the caller.
+ */
+void STLEncoder::writeLODs(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+                           const std::wstring& fileBaseName, const std::wstring& solidName,
+                           std::vector<OutputFile>& files) {
+	files.resize(mLODRatios.size());
+	for (size_t l = 0; l < mLODRatios.size(); l++) {
+		const MeshSubstitutes lodMeshes = decimateMeshes(finalizedInstances, mLODRatios[l]);
+		if (!files[l].output) {
+			const std::wstring fileName = fileBaseName + LOD_SUFFIX + std::to_wstring(l + 1) + STL_EXT;
+			openFile(fileName, solidName, countFacets(finalizedInstances, &lodMeshes), files[l]);
+		}
+		writeFacets(finalizedInstances, files[l], &lodMeshes);
+	}
+}
+
+
+/**
+ * Decimates each distinct mesh of the finalized instances (i.e. shared prototypes only once) to the given ratio
+ * of its facets. The meshes are decimated in parallel, the resulting prtx meshes are built sequentially.
+ */
+STLEncoder::MeshSubstitutes STLEncoder::decimateMeshes(
+		const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances, double ratio) const {
+	MeshSubstitutes substitutes;
+	std::vector<const prtx::Mesh*> meshes;
 	for (const auto& instance: finalizedInstances) {
 		for (const prtx::MeshPtr& m: instance.getGeometry()->getMeshes()) {
-			for (uint32_t fi = 0, n = m->getFaceCount(); fi < n; fi++) {
-				const prtx::DoubleVector& vc = m->getVertexCoords();
-
-				const uint32_t* fvi = m->getFaceVertexIndices(fi);
-				assert(m->getFaceVertexCount(fi) == 3); // we enabled triangulation above
-				uint32_t vi0 = 3 * fvi[0];
-				uint32_t vi1 = 3 * fvi[1];
-				uint32_t vi2 = 3 * fvi[2];
-
-				// using first vertex normal as face normal, see call to processVertexNormals() above
-				const uint32_t* fvni = m->getFaceVertexNormalIndices(fi);
-				const double* fn = &m->getVertexNormalsCoords()[3 * fvni[0]];
-
-				out << L"facet normal " << fn[0] << L" " << fn[1] << L" " << fn[2] << WNL;
-				out << L"  outer loop" << WNL;
-				out << L"    vertex " << vc[vi0] << L" " << vc[vi0+1] << L" " << vc[vi0+2] << WNL;
-				out << L"    vertex " << vc[vi1] << L" " << vc[vi1+1] << L" " << vc[vi1+2] << WNL;
-				out << L"    vertex " << vc[vi2] << L" " << vc[vi2+1] << L" " << vc[vi2+2] << WNL;
-				out << L"  endloop" << WNL;
-				out << L"endfacet" << WNL;
+			if (substitutes.emplace(m.get(), prtx::MeshPtr()).second)
+				meshes.push_back(m.get());
+		}
+	}
+
+	std::vector<stlenc::TriangleMesh> decimated(meshes.size());
+	std::atomic<size_t> next(0);
+	auto job = [&](unsigned) {
+		std::vector<uint32_t> triangles;
+		for (size_t i = next++; i < meshes.size(); i = next++) {
+			const prtx::Mesh& m = *meshes[i];
+			triangles.resize(size_t(3) * m.getFaceCount());
+			for (uint32_t fi = 0; fi < m.getFaceCount(); fi++)
+				std::copy_n(m.getFaceVertexIndices(fi), 3, &triangles[3 * size_t(fi)]);
+			decimated[i] = stlenc::decimate(m.getVertexCoords().data(), triangles.data(), m.getFaceCount(), ratio);
+		}
+	};
+	mWorkers->run(static_cast<unsigned>(std::min<size_t>(mWorkers->getThreadCount(), meshes.size())), job);
+
+	prtx::MeshBuilder mb;
+	for (size_t i = 0; i < meshes.size(); i++) {
+		const stlenc::TriangleMesh& dm = decimated[i];
+		std::vector<uint32_t> vertexIndices(dm.vertexCoords.size() / 3);
+		for (size_t v = 0; v < vertexIndices.size(); v++)
+			vertexIndices[v] = mb.addVertexCoords(&dm.vertexCoords[3 * v]);
+		for (size_t t = 0; t < dm.getTriangleCount(); t++) {
+			const uint32_t* tri = &dm.triangles[3 * t];
+			const double* p[3] = { &dm.vertexCoords[3 * tri[0]], &dm.vertexCoords[3 * tri[1]], &dm.vertexCoords[3 * tri[2]] };
+			const double e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+			const double e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+			double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			const double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (double& c: n)
+				c = (len > 0.0) ? c / len : 0.0;
+
+			const uint32_t ni = mb.addNormalCoords(n);
+			const uint32_t face = mb.addFace();
+			for (int v = 0; v < 3; v++) {
+				mb.addFaceVertexIndex(face, vertexIndices[tri[v]]);
+				mb.addFaceNormalIndex(face, ni);
 			}
 		}
+		substitutes[meshes[i]] = mb.createSharedAndReset();
+	}
+	return substitutes;
+}
+
+
+void STLEncoder::closeFile(OutputFile& file) {
+	prt::SimpleOutputCallbacks* soh = dynamic_cast<prt::SimpleOutputCallbacks*>(getCallbacks());
+
+	if (mFormat == Format::ASCII && !file.materialSolids)
+		file.output->append("endsolid\n");
+	file.output->finish();
+
+	const uint32_t facetCount = clampFacetCount(file.facetCount);
+	if (mFormat == Format::BINARY && facetCount != file.headerFacetCount) {
+		assert(!file.output->isCompressed()); // see init()
+		if (soh->seek(file.handle, stlenc::BINARY_HEADER_SIZE, prt::SimpleOutputCallbacks::SO_BEGIN) == prt::STATUS_OK)
+			soh->write(file.handle, reinterpret_cast<const uint8_t*>(&facetCount), sizeof(facetCount));
+		else
+			prt::log(L"STL Encoder: cannot seek to the binary header, the facet count in the header is wrong",
+			         prt::LOG_ERROR);
 	}
 
-	out << L"endsolid" << WNL;
+	soh->close(file.handle, 0, 0);
 
-	// let the client application write the file via callback
-	const std::wstring fileName = baseName + STL_EXT;
-	const uint64_t h = soh->open(ID.c_str(), prt::CT_GEOMETRY, fileName.c_str(), prt::SimpleOutputCallbacks::SE_UTF8);
-	soh->write(h, out.str().c_str());
-	soh->close(h, 0, 0);
+	mStats.facetCount += file.facetCount;
+	mStats.bytesWritten += file.output->getBytesWritten();
+	mStats.writeTime += file.output->getWriteTime();
+	mStats.compressionTime += file.output->getCompressionTime();
+	file.output.reset();
+}
+
+
+/**
+ * Writes a JSON file next to the STL file(s) via callback.
+ */
+void STLEncoder::writeSidecar(const std::wstring& fileName, const std::string& json) const {
+	prt::SimpleOutputCallbacks* soh = dynamic_cast<prt::SimpleOutputCallbacks*>(getCallbacks());
+	const uint64_t handle = soh->open(ID.c_str(), prt::CT_GEOMETRY, fileName.c_str());
+	soh->write(handle, reinterpret_cast<const uint8_t*>(json.data()), json.size());
+	soh->close(handle, 0, 0);
+}
+
+
+/**
+ * Logs the statistics of this encoder run and writes them to a JSON file next to the STL file(s).
+ */
+void STLEncoder::emitStats() const {
+	std::ostringstream json;
+	json << "{\n"
+	     << "  \"instances\": " << mStats.instanceCount << ",\n"
+	     << "  \"meshes\": " << mStats.meshCount << ",\n"
+	     << "  \"facets\": " << mStats.facetCount << ",\n"
+	     << "  \"removedFacets\": " << mStats.removedFacets << ",\n"
+	     << "  \"fixedNormals\": " << mStats.fixedNormals << ",\n"
+	     << "  \"bytesWritten\": " << mStats.bytesWritten << ",\n"
+	     << "  \"timeMs\": {\n"
+	     << "    \"addAndPrepare\": " << mStats.addTime << ",\n"
+	     << "    \"fetchFinalizedInstances\": " << mStats.fetchTime << ",\n"
+	     << "    \"formatting\": " << mStats.formatTime << ",\n"
+	     << "    \"compression\": " << mStats.compressionTime << ",\n"
+	     << "    \"writing\": " << mStats.writeTime << "\n"
+	     << "  }\n"
+	     << "}\n";
+
+	std::wostringstream msg;
+	msg << L"STL Encoder: " << mStats.instanceCount << L" instances, " << mStats.meshCount << L" meshes, "
+	    << mStats.facetCount << L" facets, " << mStats.bytesWritten << L" bytes written; add/prepare "
+	    << mStats.addTime << L" ms, fetch " << mStats.fetchTime << L" ms, formatting " << mStats.formatTime
+	    << L" ms, compression " << mStats.compressionTime << L" ms, writing " << mStats.writeTime << L" ms";
+	prt::log(msg.str().c_str(), prt::LOG_INFO);
+
+	writeSidecar(getOptions()->getString(EO_BASE_NAME) + STATS_SUFFIX, json.str());
 }
 
 
@@ -158,6 +1368,27 @@ STLEncoderFactory* STLEncoderFactory::createInstance() {
 	prtx::PRTUtils::AttributeMapBuilderPtr amb(prt::AttributeMapBuilder::create());
 	amb->setString(EO_BASE_NAME, L"stl_default_name"); // required by CityEngine
 	amb->setBool(EO_ERROR_FALLBACK, prtx::PRTX_TRUE); // required by CityEngine
+	amb->setString(EO_FORMAT, FORMAT_ASCII.c_str());
+	amb->setInt(EO_PRECISION, stlenc::DEFAULT_PRECISION);
+	amb->setInt(EO_THREADS, 1);
+	amb->setBool(EO_INCREMENTAL, prtx::PRTX_FALSE);
+	amb->setBool(EO_FILE_PER_SHAPE, prtx::PRTX_FALSE);
+	amb->setString(EO_PREPARATION, PREPARATION_FULL.c_str());
+	amb->setBool(EO_INSTANCING, prtx::PRTX_FALSE);
+	amb->setInt(EO_CACHE_SIZE, -1);
+	amb->setBool(EO_EMIT_STATS, prtx::PRTX_FALSE);
+	amb->setInt(EO_BATCH_SHAPES, 0);
+	amb->setInt(EO_BATCH_MEMORY, 0);
+	amb->setBool(EO_ASYNC_WRITES, prtx::PRTX_FALSE);
+	amb->setString(EO_LOD_RATIOS, L"");
+	amb->setFloat(EO_TILE_SIZE, 0.0);
+	amb->setBool(EO_DEDUPLICATE, prtx::PRTX_FALSE);
+	amb->setBool(EO_RECENTER, prtx::PRTX_FALSE);
+	amb->setString(EO_DIRECT_OUTPUT, L"");
+	amb->setBool(EO_SOLID_PER_MATERIAL, prtx::PRTX_FALSE);
+	amb->setFloat(EO_MIN_FACET_AREA, 0.0);
+	amb->setString(EO_COMPRESSION, stlenc::getCompressionName(stlenc::Compression::NONE));
+	amb->setInt(EO_COMPRESSION_LVL, 0);
 	encoderInfoBuilder.setDefaultOptions(amb->createAttributeMap());
 
 	// CityEngine requires the following annotations to create an UI for an option:
@@ -169,6 +1400,132 @@ STLEncoderFactory* STLEncoderFactory::createInstance() {
 			.setGroup(L"General Settings", 0.0)
 			.setDescription(L"Sets the base name of the written STL file.");
 
+	eoa.option(EO_FORMAT)
+			.setLabel(L"Format")
+			.setOrder(1.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Sets the STL flavor: 'ascii' or 'binary' (smaller and faster, single precision).");
+
+	eoa.option(EO_PRECISION)
+			.setLabel(L"Precision")
+			.setOrder(2.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Number of significant digits of ASCII coordinates, 0 writes the shortest exact representation.");
+
+	eoa.option(EO_THREADS)
+			.setLabel(L"Threads")
+			.setOrder(3.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Number of threads used to format the facets and decimate the LOD meshes, 0 uses all available cores.");
+
+	eoa.option(EO_INCREMENTAL)
+			.setLabel(L"Incremental")
+			.setOrder(4.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Writes the geometry of each initial shape as soon as it is generated instead of collecting all shapes first.");
+
+	eoa.option(EO_FILE_PER_SHAPE)
+			.setLabel(L"File per Initial Shape")
+			.setOrder(5.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Writes one file per initial shape, named after the base name and the initial shape name or index.");
+
+	eoa.option(EO_PREPARATION)
+			.setLabel(L"Geometry Preparation")
+			.setOrder(6.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"'full' or 'fast': skips vertex merging, UV and normal cleanup and computes facet normals while writing.");
+
+	eoa.option(EO_INSTANCING)
+			.setLabel(L"Instancing")
+			.setOrder(7.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Prepares inserted assets once and transforms them per instance while writing, instead of preparing every copy.");
+
+	eoa.option(EO_CACHE_SIZE)
+			.setLabel(L"Cache Size")
+			.setOrder(8.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Keeps up to this many MB of formatted ASCII output across exports, so unchanged geometry is not formatted again. The cache is shared by all exports of the process: 0 disables and releases it, -1 keeps its current size.");
+
+	eoa.option(EO_COMPRESSION)
+			.setLabel(L"Compression")
+			.setOrder(9.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Compresses the output while writing: 'none', 'gzip' (.stl.gz) or 'zstd' (.stl.zst). Binary STL is not compressed with incremental or batched writing, deduplication or facet removal.");
+
+	eoa.option(EO_COMPRESSION_LVL)
+			.setLabel(L"Compression Level")
+			.setOrder(10.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Compression level of gzip (1-9) or zstd (1-22), 0 uses the default level.");
+
+	eoa.option(EO_EMIT_STATS)
+			.setLabel(L"Emit Statistics")
+			.setOrder(11.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Logs facet counts, bytes and the time spent per encoding phase, and writes them to <base name>_stats.json.");
+
+	eoa.option(EO_BATCH_SHAPES)
+			.setLabel(L"Batch Size (Shapes)")
+			.setOrder(12.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Finalizes and writes the geometry after this many initial shapes to limit the memory usage, 0 disables batching.");
+
+	eoa.option(EO_BATCH_MEMORY)
+			.setLabel(L"Batch Size (MB)")
+			.setOrder(13.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Finalizes and writes the geometry as soon as the estimated size of the collected geometry exceeds this many MB, 0 disables batching.");
+
+	eoa.option(EO_ASYNC_WRITES)
+			.setLabel(L"Asynchronous Writes")
+			.setOrder(14.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Compresses and writes the output on a separate thread, overlapping slow storage with formatting.");
+
+	eoa.option(EO_LOD_RATIOS)
+			.setLabel(L"LOD Ratios")
+			.setOrder(15.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Semicolon-separated facet ratios, e.g. '0.5;0.1', each writes an additional decimated file <base name>_lod<n>.stl.");
+
+	eoa.option(EO_TILE_SIZE)
+			.setLabel(L"Tile Size")
+			.setOrder(16.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Splits the output into square tiles of this size on the ground plane, written to <base name>_tile_<x>_<z>.stl and indexed in <base name>_tiles.json. 0 writes a single file. With incremental or batched writing, only a few tiles are kept open, a tile continued after it was closed gets additional files <base name>_tile_<x>_<z>_part<n>.stl.");
+
+	eoa.option(EO_DEDUPLICATE)
+			.setLabel(L"Deduplicate Meshes")
+			.setOrder(17.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Writes identical meshes only once, in local coordinates, and their placements to <base name>_instances.json. The meshes are not merged per material, and all written meshes are kept until the end of the export to find their copies, so deduplication is not applied with batched writing.");
+
+	eoa.option(EO_RECENTER)
+			.setLabel(L"Recenter")
+			.setOrder(18.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Writes coordinates relative to the rounded center of the scene, e.g. to keep georeferenced coordinates precise in binary STL. The origin is written to the binary header and <base name>_origin.json.");
+
+	eoa.option(EO_DIRECT_OUTPUT)
+			.setLabel(L"Direct Output Directory")
+			.setOrder(19.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Local directory to which uncompressed binary STL is written directly through a memory-mapped file, in parallel, instead of via the output callbacks of the client. Empty uses the callbacks. Not applied with levels of detail, recentering or statistics, whose additional files are only written via the callbacks.");
+
+	eoa.option(EO_SOLID_PER_MATERIAL)
+			.setLabel(L"Solid per Material")
+			.setOrder(20.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Groups the facets by material, as one 'solid <material>' per material in ASCII STL, and writes the byte offset of each group to <base name>_materials.json.");
+
+	eoa.option(EO_MIN_FACET_AREA)
+			.setLabel(L"Minimum Facet Area")
+			.setOrder(21.0)
+			.setGroup(L"General Settings", 0.0)
+			.setDescription(L"Removes facets with a smaller area (e.g. slivers of splits) and recomputes facet normals which are not of unit length. 0 writes all facets unchanged.");
+
 	// Hide the error fallback option in the CityEngine UI.
 	eoa.option(EO_ERROR_FALLBACK).flagAsHidden();
 
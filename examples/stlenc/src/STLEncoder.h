@@ -31,10 +31,18 @@
 #include "prtx/EncoderFactory.h"
 #include "prtx/Singleton.h"
 
+#include "ChunkedOutput.h"
+#include "WorkerPool.h"
+
 #include "prt/AttributeMap.h"
 #include "prt/Callbacks.h"
 
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 
 // forward declare some classes to reduce header inclusion
@@ -48,6 +56,20 @@ public:
 	static const std::wstring NAME;
 	static const std::wstring DESCRIPTION;
 
+	/// decimated replacements of the meshes of the finalized instances, for one level of detail
+	using MeshSubstitutes = std::unordered_map<const prtx::Mesh*, prtx::MeshPtr>;
+
+	/// a range of faces of one mesh, the unit of work for gathering and formatting, see STLEncoder.cpp
+	struct FacetBlock;
+
+	/// snapped local geometry of a mesh, identifies copies of it for deduplication
+	struct MeshKey {
+		std::vector<int64_t>  localCoords;
+		std::vector<uint32_t> vertexIndices;
+
+		bool operator==(const MeshKey& other) const = default;
+	};
+
 	using prtx::GeometryEncoder::GeometryEncoder; // re-use parent constructor
 
 	STLEncoder(const STLEncoder&) = delete;
@@ -60,8 +82,132 @@ public:
 	virtual void finish(prtx::GenerateContext& context) override;
 
 private:
-	prtx::DefaultNamePreparator mNamePreparator;
-	prtx::EncodePreparatorPtr   mEncodePreparator;
+	enum class Format { ASCII, BINARY };
+
+	/// statistics of one encoder run, see the emitStats option, times in milliseconds
+	struct Stats {
+		uint64_t instanceCount = 0;
+		uint64_t meshCount = 0;
+		uint64_t facetCount = 0;
+		uint64_t bytesWritten = 0;
+		uint64_t removedFacets = 0; // degenerate facets, see the minFacetArea option
+		uint64_t fixedNormals = 0;
+		double   addTime = 0.0;
+		double   fetchTime = 0.0;
+		double   formatTime = 0.0;
+		double   compressionTime = 0.0;
+		double   writeTime = 0.0;
+	};
+
+	struct OutputFile {
+		uint64_t                               handle = 0;
+		std::unique_ptr<stlenc::ChunkedOutput> output;
+		uint64_t                               facetCount = 0;
+		uint32_t                               headerFacetCount = 0;
+		bool                                   materialSolids = false; // ASCII solids are written per material
+	};
+
+	/// grid cell of a tile on the ground plane (x and z, as PRT is y-up)
+	using TileKey = std::pair<int64_t, int64_t>;
+
+	struct TileOutput {
+		OutputFile                file; // of the current part
+		std::vector<OutputFile>   lodFiles;
+		std::vector<std::wstring> fileNames; // of all parts, a tile is continued in a new part after being closed
+		uint64_t                  facetCount = 0; // of the closed parts
+		uint64_t                  lastUse = 0;
+		double                    boundsMin[3] = { 0.0, 0.0, 0.0 }; // of the written geometry
+		double                    boundsMax[3] = { 0.0, 0.0, 0.0 };
+	};
+
+	/// a mesh written once in the deduplicated output, see the deduplicate option
+	struct UniqueMesh {
+		uint64_t firstFacet;
+		uint64_t facetCount;
+		MeshKey  key;
+	};
+
+	struct MeshOccurrence {
+		uint32_t meshId;
+		size_t   initialShapeIndex;
+		double   transform[16]; // column-major, from the written unique mesh to world coordinates
+	};
+
+	std::vector<prtx::EncodePreparator::FinalizedInstance> fetchFinalizedInstances();
+	MeshSubstitutes decimateMeshes(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+	                               double ratio) const;
+
+	void openFile(const std::wstring& fileName, const std::wstring& solidName, uint64_t expectedFacetCount,
+	              OutputFile& file) const;
+	std::string getBinaryHeader() const;
+	bool writeMappedFile(const std::wstring& fileName,
+	                     const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances);
+	void writeFacets(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+	                 OutputFile& file, const MeshSubstitutes* substitutes = nullptr);
+	std::vector<uint32_t> writeFacetBlocks(const std::vector<FacetBlock>& blocks, OutputFile& file);
+	void writeMaterialSolids(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+	                         OutputFile& file, const std::wstring& baseName);
+	void writeUniqueMeshes(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+	                       OutputFile& file);
+	void writeInstanceTable(const std::wstring& baseName) const;
+	bool reserveShapeFileName(const std::wstring& shapeName);
+	void writeShapeFile(const std::wstring& baseName, const std::wstring& shapeName,
+	                    const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances);
+	void writeDeferredShapeFiles(const std::wstring& baseName);
+	void setOrigin(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances);
+	void writeOrigin(const std::wstring& baseName) const;
+	void writeTiles(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+	                const std::wstring& baseName, bool lastWrite);
+	void closeTile(TileOutput& tile);
+	void closeTiles(const std::wstring& baseName);
+	void writeLODs(const std::vector<prtx::EncodePreparator::FinalizedInstance>& finalizedInstances,
+	               const std::wstring& fileBaseName, const std::wstring& solidName, std::vector<OutputFile>& files);
+	void closeFile(OutputFile& file);
+	void emitStats() const;
+	void writeSidecar(const std::wstring& fileName, const std::string& json) const;
+
+	prtx::DefaultNamePreparator        mNamePreparator;
+	prtx::NamePreparator::NamespacePtr mNamespaceMaterials;
+	prtx::NamePreparator::NamespacePtr mNamespaceMeshes;
+	prtx::EncodePreparatorPtr          mEncodePreparator;
+	OutputFile                         mFile;
+	std::vector<OutputFile>            mLODFiles;
+	std::map<TileKey, TileOutput>      mTiles;
+	std::map<uint64_t, TileKey>        mOpenTiles; // by last use, see writeTiles()
+	uint64_t                           mTileUses = 0;
+	std::unordered_multimap<uint64_t, uint32_t> mUniqueMeshIds; // by hash of the mesh key
+	std::vector<UniqueMesh>            mUniqueMeshes;
+	std::vector<MeshOccurrence>        mMeshOccurrences;
+	std::set<std::wstring>             mShapeFileNames; // lower case, see reserveShapeFileName()
+	std::vector<std::pair<std::wstring, std::vector<prtx::EncodePreparator::FinalizedInstance>>> mDeferredShapeFiles;
+	Stats                              mStats;
+	std::unique_ptr<stlenc::WorkerPool> mWorkers; // formats the facets and decimates the LOD meshes
+
+	Format   mFormat = Format::ASCII;
+	int32_t  mPrecision = 0;
+	bool     mIncremental = false;
+	bool     mFilePerShape = false;
+	bool     mFastPreparation = false;
+	bool     mInstancing = false;
+	bool     mEmitStats = false;
+	uint32_t mBatchShapes = 0;
+	uint64_t mBatchMemory = 0;
+	uint32_t mPendingShapes = 0;
+	uint64_t mPendingMemory = 0;
+	bool     mAsyncWrites = false;
+
+	std::vector<double> mLODRatios;
+	double              mTileSize = 0.0;
+	bool                mDeduplicate = false;
+	bool                mRecenter = false;
+	bool                mSolidPerMaterial = false;
+	double              mMinFacetArea = 0.0;
+	std::wstring        mDirectOutputPath;
+	bool                mHasOrigin = false;
+	double              mOrigin[3] = { 0.0, 0.0, 0.0 }; // subtracted from all written coordinates
+
+	stlenc::Compression mCompression = stlenc::Compression::NONE;
+	int32_t             mCompressionLevel = 0;
 };
 
 
@@ -0,0 +1,406 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "STLFormat.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#	include <emmintrin.h>
+#	define STLENC_HAS_SSE2 1
+#endif
+
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "binary STL packing assumes a little-endian host");
+
+constexpr size_t MAX_NUMBER_CHARS = 32;  // "-1.2345678901234567e-308" and some slack
+constexpr size_t MAX_FACET_CHARS  = 128 + stlenc::FACET_VALUES * (MAX_NUMBER_CHARS + 1);
+
+template <size_t N>
+inline char* put(char* p, const char (&literal)[N]) {
+	std::memcpy(p, literal, N - 1);
+	return p + N - 1;
+}
+
+inline char* putNumber(char* p, double v, int precision) {
+	const std::to_chars_result r = (precision == stlenc::PRECISION_SHORTEST)
+	        ? std::to_chars(p, p + MAX_NUMBER_CHARS, v)
+	        : std::to_chars(p, p + MAX_NUMBER_CHARS, v, std::chars_format::scientific, precision - 1);
+	return r.ptr;
+}
+
+// cross product of the edges of facet f, its length is twice the area of the facet
+inline void facetCross(const stlenc::FacetTile& tile, size_t f, double c[3]) {
+	double p[3][3];
+	for (size_t v = 0; v < 3; v++) {
+		for (size_t i = 0; i < 3; i++)
+			p[v][i] = tile.component(stlenc::FacetTile::vertex(v) + i)[f];
+	}
+	const double e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+	const double e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+	c[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	c[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	c[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+inline double doubleAreaSquared(const stlenc::FacetTile& tile, size_t f) {
+	double c[3];
+	facetCross(tile, f, c);
+	return c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+}
+
+inline char* putTriple(char* p, const stlenc::FacetTile& tile, size_t component, size_t f, int precision) {
+	p = putNumber(p, tile.component(component)[f], precision);
+	*p++ = ' ';
+	p = putNumber(p, tile.component(component + 1)[f], precision);
+	*p++ = ' ';
+	return putNumber(p, tile.component(component + 2)[f], precision);
+}
+
+} // namespace
+
+
+namespace stlenc {
+
+std::string toUTF8(const std::wstring& s) {
+	std::string r;
+	r.reserve(s.size());
+	for (size_t i = 0; i < s.size(); i++) {
+		uint32_t c = static_cast<uint32_t>(s[i]);
+		if constexpr (sizeof(wchar_t) == 2) {
+			if (c >= 0xD800 && c < 0xDC00 && i + 1 < s.size()) {
+				const uint32_t low = static_cast<uint32_t>(s[i + 1]);
+				if (low >= 0xDC00 && low < 0xE000) {
+					c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+					i++;
+				}
+			}
+		}
+		if (c < 0x80)
+			r += static_cast<char>(c);
+		else if (c < 0x800) {
+			r += static_cast<char>(0xC0 | (c >> 6));
+			r += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000) {
+			r += static_cast<char>(0xE0 | (c >> 12));
+			r += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			r += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else {
+			r += static_cast<char>(0xF0 | (c >> 18));
+			r += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+			r += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			r += static_cast<char>(0x80 | (c & 0x3F));
+		}
+	}
+	return r;
+}
+
+
+void FacetTile::resize(size_t facetCount) {
+	if (facetCount > mStride) {
+		mStride = (facetCount + 3) & ~size_t(3); // keeps the components 32 byte aligned relative to each other
+		mData.resize(FACET_VALUES * mStride);
+	}
+	mSize = facetCount;
+}
+
+
+void gatherPoints(FacetTile& tile, size_t firstComponent, const double* coords, const uint32_t* indices) {
+	double* const x = tile.component(firstComponent);
+	double* const y = tile.component(firstComponent + 1);
+	double* const z = tile.component(firstComponent + 2);
+	for (size_t f = 0, n = tile.size(); f < n; f++) {
+		const double* p = coords + 3 * size_t(indices[f]);
+		x[f] = p[0];
+		y[f] = p[1];
+		z[f] = p[2];
+	}
+}
+
+
+void computeFacetNormals(FacetTile& tile) {
+	const double* x0 = tile.component(FacetTile::vertex(0));
+	const double* y0 = tile.component(FacetTile::vertex(0) + 1);
+	const double* z0 = tile.component(FacetTile::vertex(0) + 2);
+	const double* x1 = tile.component(FacetTile::vertex(1));
+	const double* y1 = tile.component(FacetTile::vertex(1) + 1);
+	const double* z1 = tile.component(FacetTile::vertex(1) + 2);
+	const double* x2 = tile.component(FacetTile::vertex(2));
+	const double* y2 = tile.component(FacetTile::vertex(2) + 1);
+	const double* z2 = tile.component(FacetTile::vertex(2) + 2);
+	double* nx = tile.component(FacetTile::NORMAL);
+	double* ny = tile.component(FacetTile::NORMAL + 1);
+	double* nz = tile.component(FacetTile::NORMAL + 2);
+
+	size_t f = 0;
+	const size_t n = tile.size();
+#ifdef STLENC_HAS_SSE2
+	// two facets per iteration, same operations as the scalar loop below
+	const __m128d zero = _mm_setzero_pd();
+	const __m128d one = _mm_set1_pd(1.0);
+	for (; f + 2 <= n; f += 2) {
+		const __m128d vx0 = _mm_loadu_pd(x0 + f), vy0 = _mm_loadu_pd(y0 + f), vz0 = _mm_loadu_pd(z0 + f);
+		const __m128d e1x = _mm_sub_pd(_mm_loadu_pd(x1 + f), vx0);
+		const __m128d e1y = _mm_sub_pd(_mm_loadu_pd(y1 + f), vy0);
+		const __m128d e1z = _mm_sub_pd(_mm_loadu_pd(z1 + f), vz0);
+		const __m128d e2x = _mm_sub_pd(_mm_loadu_pd(x2 + f), vx0);
+		const __m128d e2y = _mm_sub_pd(_mm_loadu_pd(y2 + f), vy0);
+		const __m128d e2z = _mm_sub_pd(_mm_loadu_pd(z2 + f), vz0);
+		const __m128d cx = _mm_sub_pd(_mm_mul_pd(e1y, e2z), _mm_mul_pd(e1z, e2y));
+		const __m128d cy = _mm_sub_pd(_mm_mul_pd(e1z, e2x), _mm_mul_pd(e1x, e2z));
+		const __m128d cz = _mm_sub_pd(_mm_mul_pd(e1x, e2y), _mm_mul_pd(e1y, e2x));
+		const __m128d len = _mm_sqrt_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(cx, cx), _mm_mul_pd(cy, cy)),
+		                                           _mm_mul_pd(cz, cz)));
+		const __m128d s = _mm_and_pd(_mm_cmpgt_pd(len, zero), _mm_div_pd(one, len));
+		_mm_storeu_pd(nx + f, _mm_mul_pd(cx, s));
+		_mm_storeu_pd(ny + f, _mm_mul_pd(cy, s));
+		_mm_storeu_pd(nz + f, _mm_mul_pd(cz, s));
+	}
+#endif
+	for (; f < n; f++) {
+		const double e1[3] = { x1[f] - x0[f], y1[f] - y0[f], z1[f] - z0[f] };
+		const double e2[3] = { x2[f] - x0[f], y2[f] - y0[f], z2[f] - z0[f] };
+		const double c[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		const double len = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+		const double s = (len > 0.0) ? 1.0 / len : 0.0;
+		nx[f] = c[0] * s;
+		ny[f] = c[1] * s;
+		nz[f] = c[2] * s;
+	}
+}
+
+
+size_t removeDegenerateFacets(FacetTile& tile, double minArea) {
+	const double threshold = 4.0 * minArea * minArea; // compared to the squared double area
+	const size_t n = tile.size();
+
+	// find the first degenerate facet, usually there is none
+	size_t f = 0;
+#ifdef STLENC_HAS_SSE2
+	const double* x0 = tile.component(FacetTile::vertex(0));
+	const double* y0 = tile.component(FacetTile::vertex(0) + 1);
+	const double* z0 = tile.component(FacetTile::vertex(0) + 2);
+	const double* x1 = tile.component(FacetTile::vertex(1));
+	const double* y1 = tile.component(FacetTile::vertex(1) + 1);
+	const double* z1 = tile.component(FacetTile::vertex(1) + 2);
+	const double* x2 = tile.component(FacetTile::vertex(2));
+	const double* y2 = tile.component(FacetTile::vertex(2) + 1);
+	const double* z2 = tile.component(FacetTile::vertex(2) + 2);
+	const __m128d t = _mm_set1_pd(threshold);
+	for (; f + 2 <= n; f += 2) {
+		const __m128d vx0 = _mm_loadu_pd(x0 + f), vy0 = _mm_loadu_pd(y0 + f), vz0 = _mm_loadu_pd(z0 + f);
+		const __m128d e1x = _mm_sub_pd(_mm_loadu_pd(x1 + f), vx0);
+		const __m128d e1y = _mm_sub_pd(_mm_loadu_pd(y1 + f), vy0);
+		const __m128d e1z = _mm_sub_pd(_mm_loadu_pd(z1 + f), vz0);
+		const __m128d e2x = _mm_sub_pd(_mm_loadu_pd(x2 + f), vx0);
+		const __m128d e2y = _mm_sub_pd(_mm_loadu_pd(y2 + f), vy0);
+		const __m128d e2z = _mm_sub_pd(_mm_loadu_pd(z2 + f), vz0);
+		const __m128d cx = _mm_sub_pd(_mm_mul_pd(e1y, e2z), _mm_mul_pd(e1z, e2y));
+		const __m128d cy = _mm_sub_pd(_mm_mul_pd(e1z, e2x), _mm_mul_pd(e1x, e2z));
+		const __m128d cz = _mm_sub_pd(_mm_mul_pd(e1x, e2y), _mm_mul_pd(e1y, e2x));
+		const __m128d a = _mm_add_pd(_mm_add_pd(_mm_mul_pd(cx, cx), _mm_mul_pd(cy, cy)), _mm_mul_pd(cz, cz));
+		if (_mm_movemask_pd(_mm_cmplt_pd(a, t)) != 0)
+			break; // the scalar loop below finds which one
+	}
+#endif
+	for (; f < n && !(doubleAreaSquared(tile, f) < threshold); f++) {}
+
+	// move the remaining facets forward over the degenerate ones
+	size_t kept = f;
+	for (; f < n; f++) {
+		if (doubleAreaSquared(tile, f) < threshold)
+			continue;
+		for (size_t c = 0; c < FACET_VALUES; c++)
+			tile.component(c)[kept] = tile.component(c)[f];
+		kept++;
+	}
+	tile.truncate(kept);
+	return n - kept;
+}
+
+
+size_t fixFacetNormals(FacetTile& tile, double tolerance) {
+	double* nx = tile.component(FacetTile::NORMAL);
+	double* ny = tile.component(FacetTile::NORMAL + 1);
+	double* nz = tile.component(FacetTile::NORMAL + 2);
+	const double minLengthSquared = (1.0 - tolerance) * (1.0 - tolerance);
+	const double maxLengthSquared = (1.0 + tolerance) * (1.0 + tolerance);
+
+	size_t fixed = 0;
+	size_t f = 0;
+	const size_t n = tile.size();
+	auto fix = [&](size_t i) {
+		double c[3];
+		facetCross(tile, i, c);
+		const double len = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+		const double s = (len > 0.0) ? 1.0 / len : 0.0;
+		nx[i] = c[0] * s;
+		ny[i] = c[1] * s;
+		nz[i] = c[2] * s;
+		fixed++;
+	};
+#ifdef STLENC_HAS_SSE2
+	// checks two normals per iteration, the (rare) bad ones are recomputed one by one
+	const __m128d lo = _mm_set1_pd(minLengthSquared);
+	const __m128d hi = _mm_set1_pd(maxLengthSquared);
+	for (; f + 2 <= n; f += 2) {
+		const __m128d x = _mm_loadu_pd(nx + f), y = _mm_loadu_pd(ny + f), z = _mm_loadu_pd(nz + f);
+		const __m128d l = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)), _mm_mul_pd(z, z));
+		const int bad = _mm_movemask_pd(_mm_or_pd(_mm_cmpnge_pd(l, lo), _mm_cmpnle_pd(l, hi)));
+		if (bad & 1)
+			fix(f);
+		if (bad & 2)
+			fix(f + 1);
+	}
+#endif
+	for (; f < n; f++) {
+		const double l = nx[f] * nx[f] + ny[f] * ny[f] + nz[f] * nz[f];
+		if (!(l >= minLengthSquared && l <= maxLengthSquared))
+			fix(f);
+	}
+	return fixed;
+}
+
+
+void transformFacets(FacetTile& tile, const double* matrix) {
+	const size_t n = tile.size();
+	for (size_t v = 0; v < 3; v++) {
+		double* x = tile.component(FacetTile::vertex(v));
+		double* y = tile.component(FacetTile::vertex(v) + 1);
+		double* z = tile.component(FacetTile::vertex(v) + 2);
+		size_t f = 0;
+#ifdef STLENC_HAS_SSE2
+		// two vertices per iteration, the matrix elements are broadcast once per vertex slot
+		__m128d m[12];
+		for (int i = 0; i < 3; i++) {
+			for (int j = 0; j < 4; j++)
+				m[4 * i + j] = _mm_set1_pd(matrix[4 * j + i]); // row i, column j
+		}
+		for (; f + 2 <= n; f += 2) {
+			const __m128d px = _mm_loadu_pd(x + f);
+			const __m128d py = _mm_loadu_pd(y + f);
+			const __m128d pz = _mm_loadu_pd(z + f);
+			__m128d r[3];
+			for (int i = 0; i < 3; i++) {
+				r[i] = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m[4 * i], px), _mm_mul_pd(m[4 * i + 1], py)),
+				                  _mm_add_pd(_mm_mul_pd(m[4 * i + 2], pz), m[4 * i + 3]));
+			}
+			_mm_storeu_pd(x + f, r[0]);
+			_mm_storeu_pd(y + f, r[1]);
+			_mm_storeu_pd(z + f, r[2]);
+		}
+#endif
+		// same operation order as above, so the results do not depend on the instruction set
+		for (; f < n; f++) {
+			const double px = x[f], py = y[f], pz = z[f];
+			double* const r[3] = { x, y, z };
+			for (int i = 0; i < 3; i++)
+				r[i][f] = (matrix[i] * px + matrix[4 + i] * py) + (matrix[8 + i] * pz + matrix[12 + i]);
+		}
+	}
+}
+
+
+void convertToFloat(const double* src, float* dst, size_t n) {
+	size_t i = 0;
+#ifdef STLENC_HAS_SSE2
+	// two cvtpd2ps per four values, combined into one 128 bit store
+	for (; i + 4 <= n; i += 4) {
+		const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+		const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+		_mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+	}
+#endif
+	for (; i < n; i++)
+		dst[i] = static_cast<float>(src[i]);
+}
+
+
+void appendBinaryHeader(std::vector<uint8_t>& out, const std::string& text, uint32_t facetCount) {
+	const size_t offset = out.size();
+	out.resize(offset + BINARY_HEADER_SIZE + sizeof(uint32_t));
+	writeBinaryHeader(out.data() + offset, text, facetCount);
+}
+
+
+void writeBinaryHeader(uint8_t* dst, const std::string& text, uint32_t facetCount) {
+	const size_t textSize = std::min(text.size(), BINARY_HEADER_SIZE);
+	std::memcpy(dst, text.data(), textSize);
+	std::memset(dst + textSize, 0, BINARY_HEADER_SIZE - textSize);
+	std::memcpy(dst + BINARY_HEADER_SIZE, &facetCount, sizeof(uint32_t));
+}
+
+
+void appendBinaryFacets(std::vector<uint8_t>& out, const FacetTile& tile, std::vector<float>& floats) {
+	const size_t offset = out.size();
+	out.resize(offset + tile.size() * BINARY_FACET_SIZE);
+	writeBinaryFacets(out.data() + offset, tile, floats);
+}
+
+
+void writeBinaryFacets(uint8_t* dst, const FacetTile& tile, std::vector<float>& floats) {
+	static_assert(FACET_VALUES * sizeof(float) + sizeof(uint16_t) == BINARY_FACET_SIZE);
+
+	// convert each component at full vector width, then interleave into the packed records
+	const size_t n = tile.size();
+	floats.resize(FACET_VALUES * n);
+	for (size_t c = 0; c < FACET_VALUES; c++)
+		convertToFloat(tile.component(c), floats.data() + c * n, n);
+
+	for (size_t f = 0; f < n; f++, dst += BINARY_FACET_SIZE) {
+		for (size_t c = 0; c < FACET_VALUES; c++)
+			std::memcpy(dst + c * sizeof(float), &floats[c * n + f], sizeof(float));
+		dst[BINARY_FACET_SIZE - 2] = 0; // attribute byte count
+		dst[BINARY_FACET_SIZE - 1] = 0;
+	}
+}
+
+
+void appendASCIIFacets(std::vector<uint8_t>& out, const FacetTile& tile, int precision) {
+	const size_t n = tile.size();
+	const size_t offset = out.size();
+	out.resize(offset + n * MAX_FACET_CHARS);
+	char* const begin = reinterpret_cast<char*>(out.data() + offset);
+	char* p = begin;
+	for (size_t f = 0; f < n; f++) {
+		p = put(p, "facet normal ");
+		p = putTriple(p, tile, FacetTile::NORMAL, f, precision);
+		p = put(p, "\n  outer loop\n    vertex ");
+		p = putTriple(p, tile, FacetTile::vertex(0), f, precision);
+		p = put(p, "\n    vertex ");
+		p = putTriple(p, tile, FacetTile::vertex(1), f, precision);
+		p = put(p, "\n    vertex ");
+		p = putTriple(p, tile, FacetTile::vertex(2), f, precision);
+		p = put(p, "\n  endloop\nendfacet\n");
+	}
+	out.resize(offset + (p - begin));
+}
+
+} // namespace stlenc
@@ -0,0 +1,107 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+/**
+ * Low-level STL serialization helpers. They do not depend on PRT and operate on blocks of facets
+ * in structure-of-arrays layout, see FacetTile.
+ */
+namespace stlenc {
+
+constexpr size_t FACET_VALUES       = 12; // normal and three vertices
+constexpr size_t BINARY_HEADER_SIZE = 80;
+constexpr size_t BINARY_FACET_SIZE  = 50; // 12 float32 plus the 16 bit attribute byte count
+
+constexpr int PRECISION_SHORTEST = 0; // shortest representation which round-trips to the same double
+constexpr int DEFAULT_PRECISION  = 7; // significant digits, same as the former std::scientific stream output
+constexpr int MAX_PRECISION      = 17;
+
+/**
+ * A block of facets stored as FACET_VALUES contiguous arrays of size() values: the x, y and z components of the
+ * facet normal (components 0-2), followed by those of the three vertices (components 3-5, 6-8 and 9-11).
+ * All per-facet loops thus read and write consecutive memory and can be vectorised.
+ */
+class FacetTile {
+public:
+	static constexpr size_t NORMAL = 0;
+	static constexpr size_t vertex(size_t v) { return 3 + 3 * v; }
+
+	/// sets the number of facets, the contents are undefined afterwards
+	void resize(size_t facetCount);
+
+	/// keeps only the first facetCount facets (facetCount <= size())
+	void truncate(size_t facetCount) { mSize = facetCount; }
+	size_t size() const { return mSize; }
+
+	double* component(size_t c) { return mData.data() + c * mStride; }
+	const double* component(size_t c) const { return mData.data() + c * mStride; }
+
+private:
+	std::vector<double> mData;
+	size_t              mStride = 0;
+	size_t              mSize = 0;
+};
+
+/// encodes a wide string (UTF-16 or UTF-32, depending on the platform) as UTF-8
+std::string toUTF8(const std::wstring& s);
+
+/// copies the points coords[3 * indices[i]] of all facets i into the three components starting at firstComponent
+void gatherPoints(FacetTile& tile, size_t firstComponent, const double* coords, const uint32_t* indices);
+
+/// sets the normal of each facet to the normalized cross product of its edges (zero for degenerate facets)
+void computeFacetNormals(FacetTile& tile);
+
+/// removes the facets with an area below minArea and keeps the order of the others, returns the number removed
+size_t removeDegenerateFacets(FacetTile& tile, double minArea);
+
+/// recomputes the normals whose length differs from 1 by more than tolerance, returns the number of fixed normals
+size_t fixFacetNormals(FacetTile& tile, double tolerance);
+
+/// applies the affine part of a column-major 4x4 matrix to the vertices of each facet, the normals are left untouched
+void transformFacets(FacetTile& tile, const double* matrix);
+
+/// converts n doubles to floats, vectorised where the instruction set allows
+void convertToFloat(const double* src, float* dst, size_t n);
+
+/// appends the 80 byte header (text is truncated or zero-padded) followed by the facet count
+void appendBinaryHeader(std::vector<uint8_t>& out, const std::string& text, uint32_t facetCount);
+
+/// writes the header as appendBinaryHeader() to dst, which must hold BINARY_HEADER_SIZE + 4 bytes
+void writeBinaryHeader(uint8_t* dst, const std::string& text, uint32_t facetCount);
+
+/// appends one packed little-endian 50 byte record per facet, floats is a temporary buffer
+void appendBinaryFacets(std::vector<uint8_t>& out, const FacetTile& tile, std::vector<float>& floats);
+
+/// writes the records as appendBinaryFacets() to dst, which must hold tile.size() * BINARY_FACET_SIZE bytes
+void writeBinaryFacets(uint8_t* dst, const FacetTile& tile, std::vector<float>& floats);
+
+/// appends one ASCII "facet ... endfacet" block per facet, numbers are written with the given significant digits
+void appendASCIIFacets(std::vector<uint8_t>& out, const FacetTile& tile, int precision);
+
+} // namespace stlenc
@@ -0,0 +1,110 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+
+namespace stlenc {
+
+WorkerPool::WorkerPool(unsigned threadCount) : mThreadCount(std::max(1u, threadCount)) { }
+
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	mStart.notify_all();
+	for (std::thread& t: mThreads)
+		t.join();
+}
+
+
+void WorkerPool::run(unsigned jobCount, const std::function<void(unsigned)>& job) {
+	jobCount = std::min(jobCount, mThreadCount);
+	if (jobCount <= 1) {
+		if (jobCount == 1)
+			job(0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		while (mThreads.size() + 1 < jobCount)
+			mThreads.emplace_back(&WorkerPool::runWorker, this, static_cast<unsigned>(mThreads.size() + 1));
+		mJob = &job;
+		mJobCount = jobCount;
+		mPending = jobCount - 1;
+		mError = nullptr;
+		mGeneration++;
+	}
+	mStart.notify_all();
+
+	std::exception_ptr error;
+	try {
+		job(0);
+	}
+	catch (...) {
+		error = std::current_exception();
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDone.wait(lock, [this]() { return mPending == 0; });
+	mJob = nullptr;
+	if (!error)
+		error = mError;
+	if (error)
+		std::rethrow_exception(error);
+}
+
+
+void WorkerPool::runWorker(unsigned index) {
+	uint64_t generation = 0;
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true) {
+		mStart.wait(lock, [&]() { return mStop || mGeneration != generation; });
+		if (mStop)
+			return;
+		generation = mGeneration;
+		if (index >= mJobCount)
+			continue;
+
+		const std::function<void(unsigned)>& job = *mJob;
+		lock.unlock();
+		std::exception_ptr error;
+		try {
+			job(index);
+		}
+		catch (...) {
+			error = std::current_exception();
+		}
+		lock.lock();
+		if (error && !mError)
+			mError = error;
+		if (--mPending == 0)
+			mDone.notify_one();
+	}
+}
+
+} // namespace stlenc
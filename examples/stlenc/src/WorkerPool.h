@@ -0,0 +1,74 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace stlenc {
+
+/**
+ * A fixed set of threads which run the jobs of the encoder, so formatting many small files (e.g. one per initial
+ * shape) does not start and join threads per file. The worker threads are started on first use, and only as many
+ * as jobs were requested so far.
+ */
+class WorkerPool {
+public:
+	/// threadCount includes the calling thread, i.e. 1 runs everything on the caller
+	explicit WorkerPool(unsigned threadCount);
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool(WorkerPool&&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+	~WorkerPool();
+
+	unsigned getThreadCount() const { return mThreadCount; }
+
+	/**
+	 * Calls job(i) for i in [0, min(jobCount, getThreadCount())) concurrently, job 0 on the calling thread, and
+	 * waits until all are done. Rethrows the first exception of a job.
+	 */
+	void run(unsigned jobCount, const std::function<void(unsigned)>& job);
+
+private:
+	void runWorker(unsigned index);
+
+	const unsigned                         mThreadCount;
+	std::vector<std::thread>               mThreads; // job i runs on mThreads[i - 1]
+	std::mutex                             mMutex;
+	std::condition_variable                mStart;
+	std::condition_variable                mDone;
+	const std::function<void(unsigned)>*   mJob = nullptr;
+	unsigned                               mJobCount = 0;
+	unsigned                               mPending = 0;
+	uint64_t                               mGeneration = 0;
+	std::exception_ptr                     mError;
+	bool                                   mStop = false;
+};
+
+} // namespace stlenc
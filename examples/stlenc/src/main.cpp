@@ -24,6 +24,7 @@
  */
 
 #include "STLEncoder.h"
+#include "PLYEncoder.h"
 #include "prtx/ExtensionManager.h"
 #include <iostream>
 
@@ -41,6 +42,7 @@ extern "C" {
 STLENC_EXPORTS_API void registerExtensionFactories(prtx::ExtensionManager* manager) {
 	try {
 		manager->addFactory(STLEncoderFactory::instance());
+		manager->addFactory(PLYEncoderFactory::instance());
 	} catch (std::exception& e) {
 		std::cerr << __FUNCTION__ << " caught exception: " <<  e.what() << std::endl;
 	} catch (...) {
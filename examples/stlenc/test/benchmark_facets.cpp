@@ -0,0 +1,276 @@
+/**
+ * CityEngine SDK Custom STL Encoder Example
+ *
+ * This example demonstrates the usage of the PRTX interface
+ * to write custom encoders.
+ *
+ * See README.md in https://github.com/Esri/cityengine-sdk for build instructions.
+ *
+ * Copyright 2012-2025 (c) Esri R&D Center Zurich
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Micro-benchmark of the facet writing of the STL encoder: synthetic meshes are gathered, formatted and written
+ * with the same code as in STLEncoder, into output callbacks which only count the bytes. The measurements
+ * therefore do not include rule evaluation and geometry preparation.
+ *
+ * Usage: stlenc_benchmark <mode> <triangles per mesh> [instances] [threads]
+ * Modes: ascii, ascii-shortest, binary, binary-gzip, binary-zstd, binary-async, binary-mapped, ascii-untransformed,
+ *        binary-untransformed
+ * The instances are transformed and get computed facet normals, except in the untransformed modes, which gather
+ * the vertex normals of the mesh like untransformed shapes with full preparation. binary-async writes from a writer
+ * thread (asyncWrites), binary-mapped into a memory-mapped file in the temp directory (directOutputPath).
+ */
+
+#include "STLFormat.h"
+#include "ChunkedOutput.h"
+#include "Compression.h"
+#include "FacetWriter.h"
+#include "MappedFile.h"
+
+#include "prt/Callbacks.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#	include <windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+
+namespace {
+
+/**
+ * Stand-in for the output callbacks of a PRT client, discards all data and only counts the written bytes.
+ */
+class CountingOutputCallbacks final : public prt::SimpleOutputCallbacks {
+public:
+	uint64_t getBytesWritten() const { return mBytesWritten; }
+
+	uint64_t open(const wchar_t*, const prt::ContentType, const wchar_t*, StringEncoding, OpenMode, prt::Status*) override {
+		return 1;
+	}
+	prt::Status write(uint64_t, const wchar_t* string) override {
+		mBytesWritten += std::wcslen(string);
+		return prt::STATUS_OK;
+	}
+	prt::Status write(uint64_t, const uint8_t*, size_t size) override {
+		mBytesWritten += size;
+		return prt::STATUS_OK;
+	}
+	prt::Status close(uint64_t, const size_t*, size_t) override { return prt::STATUS_OK; }
+	prt::Status seek(uint64_t, int64_t, SeekOrigin) override { return prt::STATUS_OK; }
+	uint64_t tell(uint64_t) override { return mBytesWritten; }
+
+	prt::Status generateError(size_t, prt::Status, const wchar_t*) override { return prt::STATUS_OK; }
+	prt::Status assetError(size_t, prt::CGAErrorLevel, const wchar_t*, const wchar_t*, const wchar_t*) override {
+		return prt::STATUS_OK;
+	}
+	prt::Status cgaError(size_t, int32_t, prt::CGAErrorLevel, int32_t, int32_t, const wchar_t*) override {
+		return prt::STATUS_OK;
+	}
+	prt::Status cgaPrint(size_t, int32_t, const wchar_t*) override { return prt::STATUS_OK; }
+	prt::Status cgaReportBool(size_t, int32_t, const wchar_t*, bool) override { return prt::STATUS_OK; }
+	prt::Status cgaReportFloat(size_t, int32_t, const wchar_t*, double) override { return prt::STATUS_OK; }
+	prt::Status cgaReportString(size_t, int32_t, const wchar_t*, const wchar_t*) override { return prt::STATUS_OK; }
+	prt::Status attrBool(size_t, int32_t, const wchar_t*, bool) override { return prt::STATUS_OK; }
+	prt::Status attrFloat(size_t, int32_t, const wchar_t*, double) override { return prt::STATUS_OK; }
+	prt::Status attrString(size_t, int32_t, const wchar_t*, const wchar_t*) override { return prt::STATUS_OK; }
+	prt::Status attrBoolArray(size_t, int32_t, const wchar_t*, const bool*, size_t, size_t) override {
+		return prt::STATUS_OK;
+	}
+	prt::Status attrFloatArray(size_t, int32_t, const wchar_t*, const double*, size_t, size_t) override {
+		return prt::STATUS_OK;
+	}
+	prt::Status attrStringArray(size_t, int32_t, const wchar_t*, const wchar_t* const*, size_t, size_t) override {
+		return prt::STATUS_OK;
+	}
+
+private:
+	uint64_t mBytesWritten = 0;
+};
+
+/**
+ * Triangulated height field with the given number of triangles, i.e. an indexed mesh like the ones
+ * returned by the encode preparator.
+ */
+struct SyntheticMesh {
+	std::vector<double>   vertexCoords;
+	std::vector<uint32_t> faceVertexIndices; // 3 per triangle
+	std::vector<double>   vertexNormalsCoords; // one per vertex, as prepared for untransformed shapes
+
+	explicit SyntheticMesh(uint32_t triangleCount) {
+		const uint32_t cells = static_cast<uint32_t>(std::ceil(std::sqrt(triangleCount / 2.0)));
+		for (uint32_t y = 0; y <= cells; y++) {
+			for (uint32_t x = 0; x <= cells; x++) {
+				vertexCoords.insert(vertexCoords.end(), { x * 0.5, 0.1 * std::sin(0.3 * x) * std::cos(0.2 * y), y * 0.5 });
+				// normal of the height field, i.e. (-dh/dx, 1, -dh/dz) normalized
+				const double nx = -0.12 * std::cos(0.3 * x) * std::cos(0.2 * y);
+				const double nz = 0.08 * std::sin(0.3 * x) * std::sin(0.2 * y);
+				const double l = std::sqrt(nx * nx + 1.0 + nz * nz);
+				vertexNormalsCoords.insert(vertexNormalsCoords.end(), { nx / l, 1.0 / l, nz / l });
+			}
+		}
+		faceVertexIndices.reserve(size_t(3) * triangleCount);
+		for (uint32_t c = 0; faceVertexIndices.size() < size_t(3) * triangleCount; c++) {
+			const uint32_t v = (c / cells) * (cells + 1) + c % cells;
+			faceVertexIndices.insert(faceVertexIndices.end(), { v, v + cells + 1, v + 1 });
+			if (faceVertexIndices.size() < size_t(3) * triangleCount)
+				faceVertexIndices.insert(faceVertexIndices.end(), { v + 1, v + cells + 1, v + cells + 2 });
+		}
+	}
+
+	// the accessors of prtx::Mesh used by stlenc::gatherFacets()
+	uint32_t getFaceCount() const { return static_cast<uint32_t>(faceVertexIndices.size() / 3); }
+	uint32_t getFaceVertexCount(uint32_t) const { return 3; }
+	const uint32_t* getFaceVertexIndices(uint32_t fi) const { return &faceVertexIndices[size_t(3) * fi]; }
+	const uint32_t* getFaceVertexNormalIndices(uint32_t fi) const { return getFaceVertexIndices(fi); }
+	const std::vector<double>& getVertexCoords() const { return vertexCoords; }
+	const std::vector<double>& getVertexNormalsCoords() const { return vertexNormalsCoords; }
+};
+
+struct SyntheticBlock {
+	const SyntheticMesh* mesh;
+	uint32_t             faceBegin;
+	uint32_t             faceEnd;
+	const double*        transform;
+	bool                 flipWinding = false;
+};
+
+double getPeakMemoryMB() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS pmc;
+	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+	return pmc.PeakWorkingSetSize / double(1 << 20);
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0; // kilobytes on Linux
+#endif
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[]) {
+	if (argc < 3) {
+		std::fprintf(stderr, "usage: %s <ascii|ascii-shortest|binary|binary-gzip|binary-zstd|binary-async|binary-mapped"
+		                     "|ascii-untransformed|binary-untransformed> <triangles per mesh> [instances] [threads]\n",
+		             argv[0]);
+		return 1;
+	}
+	const std::string mode = argv[1];
+	const uint32_t triangleCount = static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10));
+	const uint32_t instanceCount = (argc > 3) ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 1;
+	const unsigned threads = (argc > 4) ? static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10))
+	                                    : std::max(1u, std::thread::hardware_concurrency());
+
+	const bool binary = (mode.compare(0, 6, "binary") == 0);
+	const int precision = (mode == "ascii-shortest") ? stlenc::PRECISION_SHORTEST : stlenc::DEFAULT_PRECISION;
+	const stlenc::Compression compression = (mode == "binary-gzip") ? stlenc::Compression::GZIP
+	                                      : (mode == "binary-zstd") ? stlenc::Compression::ZSTD
+	                                      : stlenc::Compression::NONE;
+	const bool untransformed = (mode == "ascii-untransformed" || mode == "binary-untransformed");
+	const size_t writerBuffers = (mode == "binary-async") ? 4 : 0; // WRITER_BUFFERS of the encoder
+	const bool mapped = (mode == "binary-mapped");
+	if (!stlenc::Compressor::isAvailable(compression)) {
+		std::fprintf(stderr, "mode '%s' is not available in this build\n", mode.c_str());
+		return 1;
+	}
+
+	// one shared mesh, instanced on a grid like an inserted asset, or copies in place for the untransformed modes
+	const SyntheticMesh mesh(triangleCount);
+	std::vector<double> transforms(size_t(16) * instanceCount);
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		double* m = &transforms[size_t(16) * i];
+		m[0] = m[5] = m[10] = m[15] = 1.0;
+		m[12] = 1000.0 * (i % 100);
+		m[14] = 1000.0 * (i / 100);
+	}
+	std::vector<SyntheticBlock> blocks;
+	std::vector<uint64_t> firstFacets; // for the mapped file
+	uint64_t facetCount = 0;
+	for (uint32_t i = 0; i < instanceCount; i++) {
+		for (uint32_t fb = 0, n = mesh.getFaceCount(); fb < n; fb += stlenc::FACET_BLOCK_SIZE) {
+			const double* transform = untransformed ? nullptr : &transforms[size_t(16) * i];
+			blocks.push_back({ &mesh, fb, std::min(n, fb + stlenc::FACET_BLOCK_SIZE), transform });
+			firstFacets.push_back(facetCount);
+			facetCount += blocks.back().faceEnd - blocks.back().faceBegin;
+		}
+	}
+	const double baselineMemoryMB = getPeakMemoryMB(); // the synthetic mesh, not part of the measurement
+
+	CountingOutputCallbacks callbacks;
+	stlenc::WorkerPool workers(threads);
+	uint64_t bytes = 0;
+	const auto t0 = std::chrono::steady_clock::now();
+	if (mapped) {
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "stlenc_benchmark.stl";
+		const uint64_t headerSize = stlenc::BINARY_HEADER_SIZE + sizeof(uint32_t);
+		bytes = headerSize + facetCount * stlenc::BINARY_FACET_SIZE;
+		{
+			stlenc::MappedFile file(path, bytes);
+			uint8_t* const data = file.data();
+			stlenc::writeBinaryHeader(data, "stlenc benchmark", static_cast<uint32_t>(facetCount));
+			stlenc::formatBlocksInPlace(blocks.size(), workers, [&](size_t bi, stlenc::FacetScratch& scratch) {
+				stlenc::gatherFacets(blocks[bi], true, scratch);
+				stlenc::writeBinaryFacets(data + headerSize + firstFacets[bi] * stlenc::BINARY_FACET_SIZE, scratch.tile,
+				                          scratch.floats);
+			});
+		}
+		std::filesystem::remove(path);
+	}
+	else {
+		stlenc::ChunkedOutput out(&callbacks, 1, stlenc::Compressor::create(compression, 0), writerBuffers);
+		if (binary)
+			stlenc::appendBinaryHeader(out.getBuffer(), "stlenc benchmark", static_cast<uint32_t>(facetCount));
+		else
+			out.append("solid benchmark\n");
+
+		// the gather of the encoder, see SyntheticMesh: untransformed blocks use the vertex normals
+		auto formatBlock = [binary, precision, untransformed](const SyntheticBlock& block, std::vector<uint8_t>& buffer,
+		                                                      stlenc::FacetScratch& scratch) {
+			stlenc::gatherFacets(block, !untransformed, scratch);
+			if (binary)
+				stlenc::appendBinaryFacets(buffer, scratch.tile, scratch.floats);
+			else
+				stlenc::appendASCIIFacets(buffer, scratch.tile, precision);
+		};
+		stlenc::formatBlocks(blocks, workers, out, formatBlock);
+
+		if (!binary)
+			out.append("endsolid\n");
+		out.finish();
+		bytes = callbacks.getBytesWritten();
+	}
+	const std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+	std::printf("%-20s triangles %10u  instances %6u  threads %3u  facets %11llu  %8.3f s  %12.0f facets/s"
+	            "  %8.1f MB/s  %12llu bytes  peak memory %8.1f MB above the mesh (%.1f MB)\n",
+	            mode.c_str(), triangleCount, instanceCount, threads, static_cast<unsigned long long>(facetCount),
+	            dt.count(), facetCount / dt.count(), bytes / dt.count() / (1 << 20),
+	            static_cast<unsigned long long>(bytes), getPeakMemoryMB() - baselineMemoryMB, baselineMemoryMB);
+	return 0;
+}
@@ -0,0 +1,29 @@
+#!/bin/bash
+#
+# Runs the facet writing micro-benchmark of the STL encoder for all output modes and a range of mesh sizes
+# (1K to 50M facets, as single meshes and as instanced meshes). Each run is a separate process, so the reported
+# peak memory belongs to a single mode and size. It is reported above the memory of the synthetic mesh.
+# Requires stlenc to be configured with -DSTLENC_BUILD_BENCHMARK=ON (and optionally the compression options)
+# and built in the 'build' directory (see README), or the path of the benchmark executable as first argument.
+#
+
+T="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+B=${1:-"$(dirname "${T}")/build/stlenc_benchmark"}
+THREADS=${2:-0}
+
+# triangles per mesh : number of instances
+CASES="1000:1 100000:1 1000000:1 10000000:1 1000:1000 10000:1000 1000000:50"
+
+for MODE in ascii ascii-shortest binary binary-gzip binary-zstd binary-async binary-mapped ascii-untransformed \
+  binary-untransformed
+do
+  for C in ${CASES}
+  do
+    if [ "${THREADS}" -gt 0 ]
+    then
+      "${B}" "${MODE}" "${C%%:*}" "${C##*:}" "${THREADS}"
+    else
+      "${B}" "${MODE}" "${C%%:*}" "${C##*:}"
+    fi
+  done
+done
@@ -0,0 +1,41 @@
+#!/bin/bash
+#
+# Compares the time spent in fetchFinalizedInstances with the 'full' and 'fast' geometry preparation of the STL encoder.
+# Requires prt4cmd and stlenc to be built and installed (see the respective READMEs).
+#
+
+T="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+R="$(dirname "$(dirname "${T}")")"
+P="${R}/prt4cmd/install"
+U="https://github.com/Esri/cityengine-sdk/releases/download/3.3.11669/esri_ce_sdk-example_data-v3.zip"
+D="${R}/prt4cmd/data"
+O="${T}/output"
+N=${1:-5}
+
+if [ ! -d "${D}" ]
+then
+  wget -O "${R}/prt4cmd/data.zip" "${U}"
+  unzip "${R}/prt4cmd/data.zip" -d "${R}/prt4cmd"
+fi
+
+# make the STL encoder available to prt4cmd
+cp "${R}/stlenc/install/lib/libprt_stlenc.so" "${P}/lib/"
+
+for PREP in full fast
+do
+  for I in $(seq 1 "${N}")
+  do
+    rm -rf "${O}"
+    "${P}/bin/prt4cmd" \
+         -l 1 \
+         -g "${D}/candler_footprint.obj" \
+         -p "${D}/candler.rpk" \
+         -a ruleFile:string=bin/candler.cgb \
+         -a startRule:string=Default\$Footprint \
+         -a BuildingHeight:float=45 \
+         -e com.esri.prt.examples.STLEncoder \
+         -z baseName:string=theCandler \
+         -z preparation:string=${PREP} \
+         -o "${O}" 2>&1 | grep -o "fetchFinalizedInstances.*"
+  done
+done